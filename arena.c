@@ -0,0 +1,51 @@
+/*bump allocator for per-query memory (see arena.h)*/
+#include "arena.h"
+
+// chunk header is padded so that chunk data starts aligned
+#define CHUNKHEADER ((sizeof(struct ArenaChunk)+ARENAALIGN-1) & ~(size_t)(ARENAALIGN-1))
+
+static struct ArenaChunk *newChunk(size_t size, struct ArenaChunk *next)
+{
+	struct ArenaChunk *c = (struct ArenaChunk *)malloc(CHUNKHEADER+size);
+	c->next = next;
+	c->size = size;
+	c->used = 0;
+	return c;
+}
+
+void initArena(struct Arena *a)
+{
+	a->chunk = newChunk(ARENACHUNK, NULL);
+	a->total = 0;
+}
+
+void *arenaAlloc(struct Arena *a, size_t size)
+{
+	size = (size+ARENAALIGN-1) & ~(size_t)(ARENAALIGN-1);
+	if (a->chunk->used+size > a->chunk->size) // current chunk is full: start a new one
+		a->chunk = newChunk((size > ARENACHUNK) ? size : ARENACHUNK, a->chunk);
+	void *p = (char *)a->chunk + CHUNKHEADER + a->chunk->used;
+	a->chunk->used += size;
+	a->total += size;
+	return p;
+}
+
+void resetArena(struct Arena *a)
+{
+	if (a->chunk->next != NULL) { // several chunks: replace them by one that fits the whole query
+		size_t size = (a->total > ARENACHUNK) ? a->total : ARENACHUNK;
+		freeArena(a);
+		a->chunk = newChunk(size, NULL);
+	}
+	a->chunk->used = 0;
+	a->total = 0;
+}
+
+void freeArena(struct Arena *a)
+{
+	while (a->chunk != NULL) {
+		struct ArenaChunk *next = a->chunk->next;
+		free(a->chunk);
+		a->chunk = next;
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef __ARENA
+#define __ARENA
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* bump allocator for memory that lives as long as one query (DAGs, flow computation buffers) */
+/* blocks are never freed one by one; resetArena releases everything allocated since the last reset */
+/* an arena is used by one thread only (e.g. one per batch worker), so no locking is needed */
+
+#define ARENACHUNK (1<<20) // minimum size of an arena chunk in bytes
+#define ARENAALIGN 16 // alignment of all blocks
+
+struct ArenaChunk {
+	struct ArenaChunk *next; // previously filled chunk
+	size_t size; // usable bytes in chunk
+	size_t used;
+};
+
+struct Arena {
+	struct ArenaChunk *chunk; // current chunk (first of a list of filled ones)
+	size_t total; // bytes allocated since last reset, used to size the chunk after a reset
+};
+
+void initArena(struct Arena *a);
+
+// returns a block of size bytes, aligned to ARENAALIGN
+void *arenaAlloc(struct Arena *a, size_t size);
+
+// releases all blocks; if the last query needed several chunks, they are replaced by one chunk
+// large enough for it, so that repeated queries of similar size do not allocate at all
+void resetArena(struct Arena *a);
+
+void freeArena(struct Arena *a);
+
+#endif // __ARENA
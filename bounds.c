@@ -0,0 +1,121 @@
+/*cheap bounds on the flow of a DAG (see bounds.h)*/
+#include "bounds.h"
+#include "interwindow.h"
+
+// greedy flow in time order: the interactions at the same time all take their flow from the buffers
+// as they were before that time, and only then add it to the buffers of their destinations
+static double strictGreedy(struct DAG *G)
+{
+	int i,j,k;
+	int numevents;
+	struct FlowEvent *ev = buildTimeline(G, G->edgearray, G->numedges, &numevents);
+	double *buffer = (double *)dagalloc(G, G->numnodes*sizeof(double)); // array of buffers, one for each node of the DAG
+	double *moved = (double *)dagalloc(G, (numevents+1)*sizeof(double)); // flow of each event of the current time
+
+	for (i=1; i<G->numnodes; i++)
+		buffer[i] = 0.0;
+	buffer[0] = MAXFLOW;
+	for (i=0; i<numevents; i=j) {
+		for (j=i; j<numevents && ev[j].timestamp==ev[i].timestamp; j++) {
+			moved[j] = (buffer[ev[j].src] < ev[j].quantity) ? buffer[ev[j].src] : ev[j].quantity;
+			buffer[ev[j].src] -= moved[j];
+		}
+		for (k=i; k<j; k++)
+			buffer[ev[k].dest] += moved[k];
+	}
+	double flow = buffer[G->numnodes-1];
+
+	dagfree(G, moved);
+	dagfree(G, buffer);
+	dagfree(G, ev);
+	return flow;
+}
+
+int computeFlowBounds(struct DAG *G, struct FlowBounds *b)
+{
+	int i,j;
+	int first;
+	int sink = G->numnodes-1;
+	int *order = topoorder(G);
+
+	if (order==NULL)
+		return -1;
+	double *earliest = (double *)dagalloc(G, G->numnodes*sizeof(double)); // earliest arrival at node
+	double *latest = (double *)dagalloc(G, G->numnodes*sizeof(double)); // latest departure from node
+	double *nodeflow = (double *)dagalloc(G, G->numnodes*sizeof(double)); // node capacity network
+	double *usable = (double *)dagalloc(G, (G->numedges+1)*sizeof(double)); // usable quantity of each edge
+
+	// earliest arrival at every node, in topological order; the source has all flow from the start
+	for (i=0; i<G->numnodes; i++) {
+		int v = order[i];
+		earliest[v] = (v==0) ? -MAXTIME : MAXTIME;
+		for (j=0; j<G->node[v].numinc; j++) {
+			struct Edge *e = G->edgearray[G->node[v].incedges[j]];
+			first = searchWindow(e->inter, e->numinter, earliest[e->src], 1);
+			if (first < e->numinter && e->inter[first].timestamp < earliest[v])
+				earliest[v] = e->inter[first].timestamp;
+		}
+	}
+	// latest departure from every node towards the sink, in reverse topological order
+	for (i=G->numnodes-1; i>=0; i--) {
+		int v = order[i];
+		latest[v] = (v==sink) ? MAXTIME : -MAXTIME;
+		for (j=0; j<G->node[v].numout; j++) {
+			struct Edge *e = G->edgearray[G->node[v].outedges[j]];
+			int n = windowInteractions(e->inter, e->numinter, earliest[v], latest[e->dest], &first, NULL);
+			if (n > 0 && e->inter[first+n-1].timestamp > latest[v])
+				latest[v] = e->inter[first+n-1].timestamp;
+		}
+	}
+	for (i=0; i<G->numedges; i++) {
+		struct Edge *e = G->edgearray[i];
+		windowInteractions(e->inter, e->numinter, earliest[e->src], latest[e->dest], &first, &usable[i]);
+	}
+
+	b->sourceout = 0;
+	for (j=0; j<G->node[0].numout; j++)
+		b->sourceout += usable[G->node[0].outedges[j]];
+	b->sinkin = 0;
+	for (j=0; j<G->node[sink].numinc; j++)
+		b->sinkin += usable[G->node[sink].incedges[j]];
+
+	// a node forwards at most what it receives and what it can send
+	for (i=0; i<G->numnodes; i++) {
+		int v = order[i];
+		if (v==0) {
+			nodeflow[v] = b->sourceout;
+			continue;
+		}
+		double in = 0;
+		for (j=0; j<G->node[v].numinc; j++) {
+			int id = G->node[v].incedges[j];
+			int u = G->edgearray[id]->src;
+			in += (usable[id] < nodeflow[u]) ? usable[id] : nodeflow[u];
+		}
+		double out = 0;
+		for (j=0; j<G->node[v].numout; j++)
+			out += usable[G->node[v].outedges[j]];
+		nodeflow[v] = (v==sink || in < out) ? in : out;
+	}
+	b->nodeflow = nodeflow[sink];
+
+	b->upper = b->sourceout;
+	if (b->sinkin < b->upper)
+		b->upper = b->sinkin;
+	if (b->nodeflow < b->upper)
+		b->upper = b->nodeflow;
+	b->lower = strictGreedy(G);
+
+	dagfree(G, earliest);
+	dagfree(G, latest);
+	dagfree(G, nodeflow);
+	dagfree(G, usable);
+	free(order);
+	return 0;
+}
+
+int boundsDecided(const struct FlowBounds *b)
+{
+	double scale = (b->upper > 1) ? b->upper : 1;
+	return b->upper - b->lower <= BOUNDEPS*scale;
+}
@@ -0,0 +1,32 @@
+#ifndef __BOUNDS
+#define __BOUNDS
+
+#include "computeflow.h"
+
+/* cheap bounds on the flow of a DAG, used to skip the LP when they already decide the flow */
+/* lower bound: greedy in time order where, as in the LP, flow arriving at time t can only leave after t */
+/* (computeFlowGreedy lets it leave at t, so its flow can exceed the exact flow and is not a bound) */
+/* upper bounds: every edge can carry at most the quantity of its interactions that are later than the */
+/* earliest arrival at its source node and earlier than the latest departure from its destination node; */
+/* the flow is at most the sum of these quantities out of the source, into the sink, and the flow of a */
+/* node capacity network in which no node forwards more than it can receive or send */
+/* all bounds take time linear in the number of interactions, except the sort of the greedy timeline */
+
+#define BOUNDEPS 1e-9 // lower and upper bounds closer than BOUNDEPS (relative to upper) decide the flow
+
+struct FlowBounds {
+	double lower; // flow of the greedy algorithm described above
+	double upper; // smallest of the upper bounds below
+	double sourceout; // quantity out of the source that can arrive in time
+	double sinkin; // quantity into the sink that can arrive in time
+	double nodeflow; // flow into the sink of the node capacity network
+};
+
+// computes the bounds of the flow of DAG G from its source (node at position 0) to its sink
+// (node at position G->numnodes-1); returns 0 on success, -1 if G is not a DAG
+int computeFlowBounds(struct DAG *G, struct FlowBounds *b);
+
+// returns 1 if the lower and upper bound of b are equal, i.e. b->lower is the flow of the DAG
+int boundsDecided(const struct FlowBounds *b);
+
+#endif // __BOUNDS
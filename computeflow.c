@@ -1,5 +1,6 @@
 #include "minheap.h"
 #include "computeflow.h"
+#include "interwindow.h"
 
 void printpath(struct CPattern path, int len) {
 	int i;
@@ -71,18 +72,68 @@ void writeDAGtofile(struct DAG *G2, char *filename)
 	fclose(f);
 }	
 
+// allocates size bytes for DAG G: from G's arena if it has one, else with malloc
+void *dagalloc(struct DAG *G, size_t size)
+{
+	if (G->arena != NULL)
+		return arenaAlloc(G->arena, size);
+	return malloc(size);
+}
+
+// frees a block of dagalloc (blocks of an arena are released by resetArena instead)
+void dagfree(struct DAG *G, void *p)
+{
+	if (G->arena == NULL)
+		free(p);
+}
+
+// removes all interactions of DAG edge e (they are freed only if e owns them)
+static void dropInteractions(struct Edge *e)
+{
+	if (e->owninter)
+		free(e->inter);
+	e->inter = NULL;
+	e->numinter = 0;
+	e->owninter = 0;
+}
+
+// keeps only interactions first..numinter-1 of DAG edge e
+// a view is narrowed in place; owned interactions are moved to the front of their array
+static void trimInteractions(struct Edge *e, int first)
+{
+	if (e->owninter)
+		memmove(e->inter, e->inter+first, (e->numinter-first)*sizeof(struct Interaction));
+	else
+		e->inter += first;
+	e->numinter -= first;
+}
+
+// makes DAG edge e of G own its interactions (copy-on-write), with room for maxinter of them
+// called before the interactions of e are rewritten
+// in a DAG with an arena, the copy is taken from the arena and e never owns it
+static void ownInteractions(struct DAG *G, struct Edge *e, int maxinter)
+{
+	if (e->owninter)
+		e->inter = (struct Interaction *)realloc(e->inter, maxinter*sizeof(struct Interaction));
+	else {
+		struct Interaction *inter = (struct Interaction *)dagalloc(G, maxinter*sizeof(struct Interaction));
+		memcpy(inter, e->inter, e->numinter*sizeof(struct Interaction));
+		e->inter = inter;
+		e->owninter = (G->arena == NULL);
+	}
+}
+
 // frees memory allocated by DAG
+// interactions viewed by the DAG's edges (see edgearray2DAG) are left alone
+// a DAG allocated from an arena is released with the arena (see resetArena), so nothing is done
 void freeDAG(struct DAG *G2)
 {	
+	if (G2->arena != NULL)
+		return;
 	for (int i=0; i<G2->numedges;i++) {
 		if (G2->edgearray[i]!=NULL) {
 			//printf("edge %p\n",G2->edgearray[i]);
-			if (G2->edgearray[i]->inter!=NULL) {
-				//printf("inter %p\n",G2->edgearray[i]->inter);
-				free(G2->edgearray[i]->inter);
-				G2->edgearray[i]->inter=NULL;
-			}
-			free(G2->edgearray[i]);
+			dropInteractions(G2->edgearray[i]);
 			G2->edgearray[i]=NULL;
 		}
 	}
@@ -90,16 +141,10 @@ void freeDAG(struct DAG *G2)
     	free(G2->edgearray);
     	G2->edgearray=NULL;
     } 
-	for (int i=0; i<G2->numnodes; i++) {
-		if (G2->node[i].incedges != NULL) {
-			free(G2->node[i].incedges);
-			G2->node[i].incedges=NULL;
-		}
-		if (G2->node[i].outedges != NULL) {
-			free(G2->node[i].outedges);
-			G2->node[i].outedges=NULL;
-		}
-	}
+	free(G2->edges);
+	G2->edges=NULL;
+	free(G2->adjpool); // incoming and outgoing edge lists of all nodes
+	G2->adjpool=NULL;
 	if (G2->node!=NULL) {
 		free(G2->node);
 		G2->node=NULL;
@@ -133,12 +178,15 @@ int read_graph(struct Graph *G, FILE *f)
 	int numout;
 	double ts; //timestamp
 	double qty; //quantity
-	int numline = 1;
+	long long numline = 1;
 	
-	int numedges=0;
-	int numinter=0;
+	long long numedges=0;
+	long long numinter=0;
 	double totalflow=0;
 	
+	long long maxedges = 1024; // allocated size of edge pool, doubled when full
+	long long maxinter = 4096; // allocated size of interaction pool, doubled when full
+	
 	/* read first line */
 	/* first line should be <numnodes> */
 	read = getline(&line, &len, f);
@@ -153,8 +201,19 @@ int read_graph(struct Graph *G, FILE *f)
 	
 	// Initialize data structure
 	G->node = (struct Node*)malloc(G->numnodes*sizeof(struct Node));
+	for (int i=0;i<G->numnodes;i++) {
+		G->node[i].label = -1; // label is set when node is found in the file (see phantom nodes below)
+		G->node[i].numout = 0;
+		G->node[i].edge = NULL;
+	}
+	G->edges = (struct Edge*)malloc(maxedges*sizeof(struct Edge));
+	G->inter = (struct Interaction*)malloc(maxinter*sizeof(struct Interaction));
+	G->mapaddr = NULL;
+	G->maplen = 0;
 	
 	// Read graph from file
+	// edges and interactions are appended to the pools in file order; since pools may move
+	// when they grow, Node.edge and Edge.inter are set after the whole file is read
 	while ((read = getline(&line,&len,f)) != -1)	{
 		numline++;
 		// next line to be read should be <src> <outdegree>
@@ -162,40 +221,63 @@ int read_graph(struct Graph *G, FILE *f)
 		src = atoi(token);
 		token = strtok(NULL,delim);
 		numout = atoi(token);
-		numedges+=numout;
 		//printf("%d\t%d\n",src,numout);
 		
 		G->node[src].label = src;
 		G->node[src].numout = numout;
-		G->node[src].edge = (struct Edge*)malloc(numout*sizeof(struct Edge));
+		if (numedges+numout > maxedges) {
+			while (numedges+numout > maxedges)
+				maxedges *= 2;
+			G->edges = (struct Edge*)realloc(G->edges, maxedges*sizeof(struct Edge));
+		}
 		for (j=0;j<numout;j++) {
+			struct Edge *e = &G->edges[numedges++];
 			//printf("%d\n",j);
 			read = getline(&line,&len,f);
 			numline++;
 			token = strtok(line,delim);
-			G->node[src].edge[j].src = atoi(token);
-			if (src != G->node[src].edge[j].src) {
-				printf("Problem in line %d: %d %d\n",numline,src,G->node[src].edge[j].src);
+			e->src = atoi(token);
+			if (src != e->src) {
+				printf("Problem in line %lld: %d %d\n",numline,src,e->src);
 				return -1;
 			}
 			token = strtok(NULL,delim);
-			G->node[src].edge[j].dest = atoi(token);
-			G->node[atoi(token)].label = atoi(token); 
+			e->dest = atoi(token);
+			G->node[e->dest].label = e->dest; 
 			token = strtok(NULL,delim);
-			G->node[src].edge[j].numinter = atoi(token);
-			numinter+=atoi(token);
-			G->node[src].edge[j].inter = (struct Interaction*)malloc(G->node[src].edge[j].numinter*sizeof(struct Interaction));
-			for(k=0;k<G->node[src].edge[j].numinter;k++) {
+			e->numinter = atoi(token);
+			e->owninter = 0;
+			e->inter = NULL;
+			if (numinter+e->numinter > maxinter) {
+				while (numinter+e->numinter > maxinter)
+					maxinter *= 2;
+				G->inter = (struct Interaction*)realloc(G->inter, maxinter*sizeof(struct Interaction));
+			}
+			for(k=0;k<e->numinter;k++) {
 				token = strtok(NULL,delim);
 				ts = atof(token);
 				token = strtok(NULL,delim);
 				qty = atof(token);
 				totalflow+=qty;
-				G->node[src].edge[j].inter[k].timestamp = ts;
-				G->node[src].edge[j].inter[k].quantity = qty;
+				G->inter[numinter].timestamp = ts;
+				G->inter[numinter++].quantity = qty;
 			}
 		}
 	}
+	G->numedges = numedges;
+	G->numinter = numinter;
+	
+	// set CSR positions: a node's edges start where the first edge with this src is found,
+	// an edge's interactions start after the interactions of all previous edges
+	long long curinter = 0;
+	G->summary = (struct EdgeSummary*)malloc((numedges+1)*sizeof(struct EdgeSummary));
+	for (long long e=0;e<numedges;e++) {
+		if (e==0 || G->edges[e].src!=G->edges[e-1].src)
+			G->node[G->edges[e].src].edge = &G->edges[e];
+		G->edges[e].inter = &G->inter[curinter];
+		curinter += G->edges[e].numinter;
+		summarizeEdge(&G->edges[e], &G->summary[e]);
+	}
 	
 	// handle "phantom" nodes: these are nodes that have no outgoing and no incoming edges
 	// they correspond to nodes in the original graph with self-loops only (which were disregarded by the conversion program)
@@ -208,9 +290,11 @@ int read_graph(struct Graph *G, FILE *f)
 			//if (G->node[i].numout>0)
 			//	break;
 		}
+	indexIncomingEdges(G);
+	
 	printf("numnodes=%d\n",G->numnodes);
-	printf("numedges=%d\n",numedges);
-	printf("numinteractions=%d\n",numinter);
+	printf("numedges=%lld\n",numedges);
+	printf("numinteractions=%lld\n",numinter);
 	printf("average flow per interaction=%f\n",totalflow/numinter);
 	printf("numphantoms = %d\n",cphantoms);
 	
@@ -236,74 +320,162 @@ void printGraph(struct Graph *G)
 	}
 }
 
+// computes the summary of the interactions of edge e (interactions are sorted by time)
+void summarizeEdge(struct Edge *e, struct EdgeSummary *s)
+{
+	s->numinter = e->numinter;
+	s->pad = 0;
+	s->totqty = sumQuantities(e->inter, e->numinter);
+	s->mintime = (e->numinter>0) ? e->inter[0].timestamp : 0;
+	s->maxtime = (e->numinter>0) ? e->inter[e->numinter-1].timestamp : 0;
+}
+
+// builds the incoming-edge index of G (incoff, incedges); called by the graph readers
+// incoming edges are grouped by dest with a counting sort over the edge pool
+void indexIncomingEdges(struct Graph *G)
+{
+	G->incoff = (long long *)calloc(G->numnodes+1,sizeof(long long));
+	G->incedges = (struct Edge **)malloc((G->numedges+1)*sizeof(struct Edge *));
+	for (long long e=0;e<G->numedges;e++)
+		G->incoff[G->edges[e].dest+1]++;
+	for (int i=0;i<G->numnodes;i++)
+		G->incoff[i+1] += G->incoff[i];
+	long long *fill = (long long *)malloc((G->numnodes+1)*sizeof(long long));
+	memcpy(fill,G->incoff,(G->numnodes+1)*sizeof(long long));
+	for (long long e=0;e<G->numedges;e++)
+		G->incedges[fill[G->edges[e].dest]++] = &G->edges[e];
+	free(fill);
+}
+
+// frees memory allocated by read_graph or read_graph_bin
+void freeGraph(struct Graph *G)
+{
+	free(G->edges);
+	G->edges = NULL;
+	free(G->incoff);
+	G->incoff = NULL;
+	free(G->incedges);
+	G->incedges = NULL;
+	if (G->mapaddr != NULL) {
+		// interaction pool and edge summaries are part of the mapped file
+		munmap(G->mapaddr, G->maplen);
+		G->mapaddr = NULL;
+	}
+	else {
+		free(G->inter);
+		free(G->summary);
+	}
+	G->inter = NULL;
+	G->summary = NULL;
+	free(G->node);
+	G->node = NULL;
+}
+
+// DAG id of graph node id u in map m, or the empty slot where u belongs
+// (open addressing with linear probing; m has tablesize a power of 2 and is at most half full)
+static inline int nodeMapSlot(struct NodeMap *m, int u)
+{
+	int slot = (int)(((unsigned int)u * 0x9E3779B1u) >> 7) & (m->tablesize-1);
+	while (m->key[slot] != -1 && m->key[slot] != u)
+		slot = (slot+1) & (m->tablesize-1);
+	return slot;
+}
+
+// returns DAG id of graph node id u; u gets the next free id *nn if it has none yet
+// (nodesarray keeps the graph node id of every DAG id)
+static inline int mapNode(struct NodeMap *m, int u, int *nodesarray, int *nn)
+{
+	int slot = nodeMapSlot(m, u);
+	if (m->key[slot] == -1) {
+		m->key[slot] = u;
+		m->val[slot] = *nn;
+		nodesarray[(*nn)++] = u; //give new label to newly found node
+	}
+	return m->val[slot];
+}
+
 // converts edgearray to DAG
 // edgearray[0]->src considered to be source node
 // nodes-ids and src/dest are mapped to a continuous id range [0,numnodes-1]
+// (in order of first appearance, through a hash map, so the cost is linear in numedges)
+// incoming and outgoing edge lists of all nodes are stored in one array (see DAG.adjpool)
+// the DAG and all its blocks are allocated from arena (NULL: malloc, released by freeDAG)
 // returns constructed DAG
 // set writefile=1 if you want constructed DAG to be written to file DAG.txt
-struct DAG *edgearray2DAG(struct Edge** edgearray, int numedges, int sink, int writefile)
+struct DAG *edgearray2DAG(struct Edge** edgearray, int numedges, int sink, int writefile, struct Arena *arena)
 {
 	int i,j,k;
 	struct DAG *G2;
 	int writtendest;
+	struct NodeMap m;
 	
+	G2 = (struct DAG *)((arena != NULL) ? arenaAlloc(arena, sizeof(struct DAG)) : malloc(sizeof(struct DAG)));
+	G2->arena = arena;
+
+	//DAG.edgearray is going to be a copy of edgearray because we're going to change the 
+	//src, dest of each node
+	//the interactions are not copied: DAG edges view the interactions of the edges in edgearray,
+	//which must outlive the DAG; they are copied only when they are rewritten (see ownInteractions)
+	G2->numedges = numedges;
+	G2->edges = (struct Edge *)dagalloc(G2, (numedges+1)*sizeof(struct Edge)); // one block for all edges
+	G2->edgearray = (struct Edge **)dagalloc(G2, (numedges+1)*sizeof(struct Edge *)); 
+
 	//first nodes-ids and src/dest should be mapped to continuous ids in [0,numnodes-1]
 	//source node should be 0, sink node should be numnodes-1 
-	int *nodesarray = (int *)malloc(numedges*sizeof(int)); //keeps the true labels of the nodes in an array
-	int nn =1; // number of nodes
-	nodesarray[0]=edgearray[0]->src; //source node of DAG goes first
+	int *nodesarray = (int *)dagalloc(G2, (numedges+2)*sizeof(int)); //keeps the true labels of the nodes in an array (sink included)
+	int nn = 0; // number of nodes
+	for (m.tablesize=16; m.tablesize<2*(numedges+1); m.tablesize*=2);
+	m.key = (int *)dagalloc(G2, m.tablesize*sizeof(int));
+	m.val = (int *)dagalloc(G2, m.tablesize*sizeof(int));
+	memset(m.key,-1,m.tablesize*sizeof(int));
+	mapNode(&m, edgearray[0]->src, nodesarray, &nn); //source node of DAG goes first
 	for (i=0; i<numedges;i++) {
-		if ((searcharray(nodesarray,  nn, edgearray[i]->src))==-1)
-			nodesarray[nn++]=edgearray[i]->src; //give new label to newly found node
-		if (edgearray[i]->dest!=sink && (searcharray(nodesarray,  nn, edgearray[i]->dest))==-1)
-			nodesarray[nn++]=edgearray[i]->dest; //give new label to newly found node		
+		G2->edgearray[i]=&G2->edges[i];
+		G2->edgearray[i]->inter=edgearray[i]->inter;
+		G2->edgearray[i]->owninter=0;
+		G2->edgearray[i]->numinter=edgearray[i]->numinter;
+		G2->edgearray[i]->src=mapNode(&m, edgearray[i]->src, nodesarray, &nn);
+		if (edgearray[i]->dest==sink) //special handling of sink node (in case it is the same as source)
+			G2->edgearray[i]->dest=-1; // set below, when number of nodes is known
+		else
+			G2->edgearray[i]->dest=mapNode(&m, edgearray[i]->dest, nodesarray, &nn);
 	}
 	nodesarray[nn]=nn; // sink node of DAG goes last and takes last label (artificial)
 	nn++;
+	dagfree(G2, m.key);
+	dagfree(G2, m.val);
 	/*for (int i=0; i<nn-1; i++)
 		printf("%d, ",nodesarray[i]);
 	printf("%d\n",nodesarray[nn-1]);*/
 	
-	G2 = (struct DAG *)malloc(sizeof(struct DAG));
 	G2->numnodes = nn;
-	G2->node = (struct DAGNode *)malloc(G2->numnodes*sizeof(struct DAGNode));
+	G2->node = (struct DAGNode *)dagalloc(G2, G2->numnodes*sizeof(struct DAGNode));
 	for (i=0; i<G2->numnodes; i++) {
 		G2->node[i].label = i;
 		G2->node[i].numinc = 0; //initialize number of incoming edges to node
 		G2->node[i].numout = 0; //initialize number of outgoing edges from node
 	}
-
-	//DAG.edgearray is going to be a copy of edgearray because we're going to change the 
-	//src, dest of each node
-	//we should also copy the interactions
-	G2->numedges = numedges;
-	G2->edgearray = (struct Edge **)malloc(numedges*sizeof(struct Edge *)); 
 	for (i=0; i<numedges;i++) {
-		G2->edgearray[i]=(struct Edge *)malloc(numedges*sizeof(struct Edge));
-		G2->edgearray[i]->inter=(struct Interaction *)malloc(edgearray[i]->numinter*sizeof(struct Interaction));
-		//printf("new inter allocated %p for edgearray %p\n", G2->edgearray[i]->inter, G2->edgearray[i]);
-		for(j=0; j<edgearray[i]->numinter; j++)
-			G2->edgearray[i]->inter[j]=edgearray[i]->inter[j]; 
-		G2->edgearray[i]->numinter=edgearray[i]->numinter;
-		G2->edgearray[i]->src=searcharray(nodesarray,  nn, edgearray[i]->src);
-		G2->node[G2->edgearray[i]->src].numout++;
-		G2->edgearray[i]->dest=searcharray(nodesarray,  nn, edgearray[i]->dest);
-		if (edgearray[i]->dest==sink) //special handling of sink node (in case it is the same as source)
+		if (G2->edgearray[i]->dest==-1)
 			G2->edgearray[i]->dest=nn-1;
+		G2->node[G2->edgearray[i]->src].numout++;
 		G2->node[G2->edgearray[i]->dest].numinc++;
 	}
 	
-	// mem alloc
+	// incoming edges of all nodes, then outgoing edges of all nodes, node after node
+	G2->adjpool = (int *)dagalloc(G2, (2*numedges+1)*sizeof(int));
+	k = 0;
 	for (i=0; i<G2->numnodes; i++) {
-		//printf("Node %d has %d outgoing edges\n",i,G2->node[i].numout);
-		//printf("Node %d has %d incoming edges\n",i,G2->node[i].numinc);
-		G2->node[i].incedges = (int *)malloc(G2->node[i].numinc*sizeof(int));
-		G2->node[i].outedges = (int *)malloc(G2->node[i].numout*sizeof(int));
+		G2->node[i].incedges = G2->adjpool+k;
+		k += G2->node[i].numinc;
+	}
+	for (i=0; i<G2->numnodes; i++) {
+		G2->node[i].outedges = G2->adjpool+k;
+		k += G2->node[i].numout;
 		G2->node[i].numinc=0; //reset in order to increase again when adding the edges
 		G2->node[i].numout=0; //reset in order to increase again when adding the edges	
 	}
 	
-	
 	// set incoming and outgoing edges for each node	
 	for (i=0; i<numedges;i++) {
 		G2->node[G2->edgearray[i]->src].outedges[G2->node[G2->edgearray[i]->src].numout++]=i;
@@ -339,7 +511,7 @@ struct DAG *edgearray2DAG(struct Edge** edgearray, int numedges, int sink, int w
 		fclose(f);
 	}
 
-	free(nodesarray);
+	dagfree(G2, nodesarray);
 	
 	return G2;
 }
@@ -408,9 +580,7 @@ int delnode(struct DAG *G, int n, int **deletededges, int *numdeletededges, int
 	for (int j=0; j<G->node[n].numinc; j++) { //for each incoming edge of current node
 		if (!(*deletededges)[G->node[n].incedges[j]]) {
 			//printf("edge %d->%d deleted\n",G->edgearray[G->node[n].incedges[j]]->src,G->edgearray[G->node[n].incedges[j]]->dest);
-			free(G->edgearray[G->node[n].incedges[j]]->inter);
-			G->edgearray[G->node[n].incedges[j]]->inter = NULL;
-			G->edgearray[G->node[n].incedges[j]]->numinter = 0;
+			dropInteractions(G->edgearray[G->node[n].incedges[j]]);
 			(*numdeletedinter)+=G->edgearray[G->node[n].incedges[j]]->numinter; //update number of deleted interactions
 			(*deletededges)[G->node[n].incedges[j]]=1;
 			(*numdeletededges)++;
@@ -435,31 +605,141 @@ int delnode(struct DAG *G, int n, int **deletededges, int *numdeletededges, int
 	return ret;
 }
 
+// backward pass of preprocessDAG: accesses the DAG in reverse topological order and removes the incoming
+// interactions of every node v that are not earlier than all remaining outgoing interactions of v
+// (flow that arrives at time t can only leave at a later time)
+// an edge that loses all its interactions is deleted, and so is its origin node if it has no outgoing
+// edges left (by function delnode); returns -1 if the source node of DAG is deleted, else returns 0
+static int pruneBackward(struct DAG *G, int *order, int **deletededges, int *numdeletededges, int **deletednodes, int *numdeletednodes, int **numdeletedout, int *numdeletedinter)
+{
+	int sink = G->numnodes-1;
+
+	for (int i=G->numnodes-1; i>0; i--) {
+		int v = order[i];
+		if (v==sink || (*deletednodes)[v])
+			continue;
+
+		// max timestamp in all outgoing edges of current node
+		double maxtimeout = -MAXTIME;
+		for (int j=0; j<G->node[v].numout; j++)
+			if (!(*deletededges)[G->node[v].outedges[j]]) {
+				struct Edge *e = G->edgearray[G->node[v].outedges[j]];
+				if (e->inter[e->numinter-1].timestamp > maxtimeout)
+					maxtimeout = e->inter[e->numinter-1].timestamp;
+			}
+
+		for (int j=0; j<G->node[v].numinc; j++) {
+			int id = G->node[v].incedges[j];
+			if ((*deletededges)[id])
+				continue;
+			// interactions are sorted by time, so the removed ones form a suffix
+			struct Edge *e = G->edgearray[id];
+			int last = searchWindow(e->inter, e->numinter, maxtimeout, 0);
+			(*numdeletedinter) += e->numinter-last;
+			e->numinter = last;
+			if (e->numinter)
+				continue;
+			dropInteractions(e);
+			(*deletededges)[id]=1;
+			(*numdeletededges)++;
+			(*numdeletedout)[e->src]++;
+			if ((*numdeletedout)[e->src]==G->node[e->src].numout) {
+				if (e->src==0) // the source of DAG lost all its edges: the DAG has 0 flow
+					return -1;
+				if (delnode(G,e->src,deletededges,numdeletededges,deletednodes,numdeletednodes,numdeletedout,numdeletedinter)==-1)
+					return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+// removes the edges marked in deletededges from DAG G in place, and the nodes left without edges
+// surviving edges and nodes keep their relative order and are renumbered in one pass over the edge lists;
+// as in edgearray2DAG, source stays node 0, sink stays the last node and the first edge leaves the source
+static void compactDAG(struct DAG *G, int *deletededges)
+{
+	int i,k;
+	int sink = G->numnodes-1;
+	int *newedge = (int *)dagalloc(G, (G->numedges+1)*sizeof(int));
+	int *newnode = (int *)dagalloc(G, G->numnodes*sizeof(int));
+
+	int numedges = 0;
+	int sourcepos = -1; // new position of first edge from source
+	for (i=0; i<G->numedges; i++)
+		if (!deletededges[i]) {
+			if (sourcepos == -1 && G->edgearray[i]->src==0)
+				sourcepos = numedges;
+			G->edgearray[numedges] = G->edgearray[i];
+			newedge[i] = numedges++;
+		}
+	if (sourcepos > 0) { // swap it with the first edge
+		struct Edge *tmp = G->edgearray[sourcepos];
+		G->edgearray[sourcepos] = G->edgearray[0];
+		G->edgearray[0] = tmp;
+		for (i=0; i<G->numedges; i++)
+			if (!deletededges[i] && (newedge[i]==0 || newedge[i]==sourcepos))
+				newedge[i] = sourcepos-newedge[i];
+	}
+
+	// edge lists shrink within their part of the adjpool
+	int numnodes = 0;
+	for (i=0; i<G->numnodes; i++) {
+		struct DAGNode *v = &G->node[i];
+		int n = 0;
+		for (k=0; k<v->numinc; k++)
+			if (!deletededges[v->incedges[k]])
+				v->incedges[n++] = newedge[v->incedges[k]];
+		v->numinc = n;
+		n = 0;
+		for (k=0; k<v->numout; k++)
+			if (!deletededges[v->outedges[k]])
+				v->outedges[n++] = newedge[v->outedges[k]];
+		v->numout = n;
+		if (v->numinc+v->numout==0 && i!=0 && i!=sink) {
+			newnode[i] = -1;
+			continue;
+		}
+		newnode[i] = numnodes;
+		G->node[numnodes] = *v;
+		G->node[numnodes].label = numnodes;
+		numnodes++;
+	}
+	for (i=0; i<numedges; i++) {
+		G->edgearray[i]->src = newnode[G->edgearray[i]->src];
+		G->edgearray[i]->dest = newnode[G->edgearray[i]->dest];
+	}
+	G->numedges = numedges;
+	G->numnodes = numnodes;
+
+	dagfree(G, newedge);
+	dagfree(G, newnode);
+}
+
 // accesses DAG in topological order "*order" and removes interactions that cannot contribute to flow
 // an interaction is removed if its timestamp is smaller than the min-timestamp of all incoming
-// interactions to its source node
+// interactions to its source node (forward pass), or if it is not smaller than the max-timestamp of all
+// outgoing interactions of its destination node (backward pass, function pruneBackward); the two passes
+// are repeated until they delete no more edges, and edges are trimmed in place
 // if an edge has 0 interactions then remove edge 
 // if a node has no incoming edges, remove node and recursively its children if needed 
 // if a node has no outgoing edges, node is deleted by function delnode 
 // if source of DAG loses connection to sink, we discover this and return a NULL DAG 
-// else if some edges are deleted, constructs and creates a new DAG
-// else returns the input DAG (with some interactions possibly deleted)
+// else returns the input DAG, with deleted interactions, edges and nodes removed in place (see compactDAG)
 struct DAG *preprocessDAG(struct DAG *G, int *order, int *numdeletedinter, int *numdeletededges, int *numdeletednodes)
 {
 	double m; // auxiliary variable
 	int ret = 0; //returned value
 	
-	struct DAG *newdag = NULL; 
-		
-	struct Interaction *newinter;
-	int newnuminter;
-	
 	//marks deleted edges
-	int *deletededges = (int *)calloc(G->numedges,sizeof(int));
+	int *deletededges = (int *)dagalloc(G, (G->numedges+1)*sizeof(int));
+	memset(deletededges,0,G->numedges*sizeof(int));
 	//marks deleted nodes
-	int *deletednodes = (int *)calloc(G->numnodes,sizeof(int));
+	int *deletednodes = (int *)dagalloc(G, G->numnodes*sizeof(int));
+	memset(deletednodes,0,G->numnodes*sizeof(int));
 	//keeps track of number of outgoing deleted edges from each node	
-	int *numdeletedout = (int *)calloc(G->numnodes,sizeof(int)); 
+	int *numdeletedout = (int *)dagalloc(G, G->numnodes*sizeof(int)); 
+	memset(numdeletedout,0,G->numnodes*sizeof(int));
 
 	*numdeletedinter=0; // total number of removed interactions
 	*numdeletededges=0; // total number of removed edges
@@ -486,85 +766,91 @@ struct DAG *preprocessDAG(struct DAG *G, int *order, int *numdeletedinter, int *
 		if (!deletededges[i])
 			printf("edge %d->%d is there\n",G->edgearray[i]->src,G->edgearray[i]->dest);
 */
-	// source node of DAG is always first in the topo order, so we skip it, as it has no incoming edges
-	for(int i=1; i<G->numnodes; i++)
+	// forward and backward passes alternate until a pass deletes no edge: a pass only trims one end of the
+	// interactions of an edge, so it changes what the other pass sees only when an edge becomes empty
+	int sink = G->numnodes-1;
+	int prevdeletededges = -1;
+	for (int pass=0; !ret && (pass<2 || *numdeletededges!=prevdeletededges); pass++)
 	{
-		//printf("Examining node %d\n",order[i]);
+		prevdeletededges = *numdeletededges;
+		if (pass%2)
+		{
+			ret = pruneBackward(G, order, &deletededges, numdeletededges, &deletednodes, numdeletednodes, &numdeletedout, numdeletedinter);
+			continue;
+		}
+		// forward pass: source node of DAG is always first in the topo order, so we skip it, as it has no incoming edges
+		for(int i=1; i<G->numnodes; i++)
+		{
+			if (deletednodes[order[i]]) // deleted by an earlier pass
+				continue;
+			//printf("Examining node %d\n",order[i]);
 		
-		//step 1: find min timestamp in all incoming edges to current node
-		double mintimein = MAXTIME; // CAUTION: make sure MAXTIME is larger than all timestamps in your graph
-		for (int j=0; j<G->node[order[i]].numinc; j++)
-			if (!deletededges[G->node[order[i]].incedges[j]])
-				if ((m=G->edgearray[G->node[order[i]].incedges[j]]->inter[0].timestamp)<mintimein)
-					mintimein=m;
+			//step 1: find min timestamp in all incoming edges to current node
+			double mintimein = MAXTIME; // CAUTION: make sure MAXTIME is larger than all timestamps in your graph
+			for (int j=0; j<G->node[order[i]].numinc; j++)
+				if (!deletededges[G->node[order[i]].incedges[j]])
+					if ((m=G->edgearray[G->node[order[i]].incedges[j]]->inter[0].timestamp)<mintimein)
+						mintimein=m;
 		
-		if (mintimein==MAXTIME) // special case where all incoming edges to current node are deleted
-		{
-			// ALL incoming edges to this node are marked as deleted
-			// we should now mark this node as deleted
-			// and mark as deleted all its outgoing edges
-			//printf("node %d deleted\n",order[i]);
-			//printf("node %d will be deleted\n",order[i]);
-			deletednodes[order[i]]=1;
-			(*numdeletednodes)++;
-			for (int j=0; j<G->node[order[i]].numout; j++) { //for each outgoing edge of current node
-				if (!deletededges[G->node[order[i]].outedges[j]]) {
-					//printf("edge %d->%d deleted\n",G->edgearray[G->node[order[i]].outedges[j]]->src,G->edgearray[G->node[order[i]].outedges[j]]->dest);
-					free(G->edgearray[G->node[order[i]].outedges[j]]->inter);
-					(*numdeletedinter)+=G->edgearray[G->node[order[i]].outedges[j]]->numinter;
-					G->edgearray[G->node[order[i]].outedges[j]]->inter = NULL;
-					G->edgearray[G->node[order[i]].outedges[j]]->numinter = 0;
-					deletededges[G->node[order[i]].outedges[j]]=1;
-					(*numdeletededges)++;
-					numdeletedout[order[i]]++;
-				}
-			}
-			if (i==G->numnodes-1)
+			if (mintimein==MAXTIME) // special case where all incoming edges to current node are deleted
 			{
-				//sink node is deleted!
-				//flow is 0
-				//printf("Sink node deleted!\n");
-				ret = -1;
-				break;
-			}
-		}	
-		//printf("mintimestamp into node %d is %f\n",order[i],mintimein);
-		else //not all incoming edges to current node are deleted
-		{
-			for (int j=0; j<G->node[order[i]].numout; j++) { //for each outgoing edge of current node
-				if (!deletededges[G->node[order[i]].outedges[j]]) {
-					newinter = (struct Interaction *)malloc(G->edgearray[G->node[order[i]].outedges[j]]->numinter*sizeof(struct Interaction));
-					newnuminter=0;
-					for (int k=0; k<G->edgearray[G->node[order[i]].outedges[j]]->numinter; k++)
-						if (G->edgearray[G->node[order[i]].outedges[j]]->inter[k].timestamp>mintimein) {
-							//printf("timestamp %f from node %d should be deleted\n",G->edgearray[G->node[order[i]].outedges[j]]->inter[k].timestamp,order[i]);
-							newinter[newnuminter].timestamp=G->edgearray[G->node[order[i]].outedges[j]]->inter[k].timestamp;
-							newinter[newnuminter++].quantity=G->edgearray[G->node[order[i]].outedges[j]]->inter[k].quantity;
-						}
-						else (*numdeletedinter)++;
-					free(G->edgearray[G->node[order[i]].outedges[j]]->inter);
-					G->edgearray[G->node[order[i]].outedges[j]]->inter=newinter;
-					G->edgearray[G->node[order[i]].outedges[j]]->numinter=newnuminter;
-					if (!newnuminter) // all interactions on edge are removed
-					{
-						//mark edge as deleted
+				// ALL incoming edges to this node are marked as deleted
+				// we should now mark this node as deleted
+				// and mark as deleted all its outgoing edges
+				//printf("node %d deleted\n",order[i]);
+				//printf("node %d will be deleted\n",order[i]);
+				deletednodes[order[i]]=1;
+				(*numdeletednodes)++;
+				for (int j=0; j<G->node[order[i]].numout; j++) { //for each outgoing edge of current node
+					if (!deletededges[G->node[order[i]].outedges[j]]) {
 						//printf("edge %d->%d deleted\n",G->edgearray[G->node[order[i]].outedges[j]]->src,G->edgearray[G->node[order[i]].outedges[j]]->dest);
+						(*numdeletedinter)+=G->edgearray[G->node[order[i]].outedges[j]]->numinter;
+						dropInteractions(G->edgearray[G->node[order[i]].outedges[j]]);
 						deletededges[G->node[order[i]].outedges[j]]=1;
 						(*numdeletededges)++;
 						numdeletedout[order[i]]++;
 					}
 				}
-			}
-			if (G->node[order[i]].numout>0 && numdeletedout[order[i]]==G->node[order[i]].numout)
+				if (order[i]==sink)
+				{
+					//sink node is deleted!
+					//flow is 0
+					//printf("Sink node deleted!\n");
+					ret = -1;
+					break;
+				}
+			}	
+			//printf("mintimestamp into node %d is %f\n",order[i],mintimein);
+			else //not all incoming edges to current node are deleted
 			{
-				// ALL outgoing edges from this node are marked as deleted
-				// and this node is not the sink
-				// this node and its incoming edges should be deleted
-				// then, delete recursively the node's parent if applicable
-				// we must keep track the number of deleted edges for each node
-				//printf("node %d is deleted\n",order[i]);
-				ret = delnode(G,order[i],&deletededges,numdeletededges,&deletednodes,numdeletednodes,&numdeletedout,numdeletedinter);
-				if (ret==-1) break; //DAG's source node deleted
+				for (int j=0; j<G->node[order[i]].numout; j++) { //for each outgoing edge of current node
+					if (!deletededges[G->node[order[i]].outedges[j]]) {
+						// interactions are sorted by time, so the removed ones form a prefix
+						struct Edge *e = G->edgearray[G->node[order[i]].outedges[j]];
+						int first = searchWindow(e->inter, e->numinter, mintimein, 1);
+						(*numdeletedinter) += first;
+						trimInteractions(e, first);
+						if (!e->numinter) // all interactions on edge are removed
+						{
+							//mark edge as deleted
+							//printf("edge %d->%d deleted\n",G->edgearray[G->node[order[i]].outedges[j]]->src,G->edgearray[G->node[order[i]].outedges[j]]->dest);
+							deletededges[G->node[order[i]].outedges[j]]=1;
+							(*numdeletededges)++;
+							numdeletedout[order[i]]++;
+						}
+					}
+				}
+				if (G->node[order[i]].numout>0 && numdeletedout[order[i]]==G->node[order[i]].numout)
+				{
+					// ALL outgoing edges from this node are marked as deleted
+					// and this node is not the sink
+					// this node and its incoming edges should be deleted
+					// then, delete recursively the node's parent if applicable
+					// we must keep track the number of deleted edges for each node
+					//printf("node %d is deleted\n",order[i]);
+					ret = delnode(G,order[i],&deletededges,numdeletededges,&deletednodes,numdeletednodes,&numdeletedout,numdeletedinter);
+					if (ret==-1) break; //DAG's source node deleted
+				}
 			}
 		}
 	}
@@ -573,44 +859,14 @@ struct DAG *preprocessDAG(struct DAG *G, int *order, int *numdeletedinter, int *
 	
 
 	if (!ret && (*numdeletededges))
-	{
-		// if at least one edge is deleted, we update the DAG
-		
-		// not the fastest way, but this is what we have now
-		struct Edge **edgearray = (struct Edge **)malloc(G->numedges*sizeof(struct Edge *));
-		int numedges = 0;
-
-		// copy non-deleted edge to edgearray
-		int sourcepos = -1; //used to swap edges if first edge in edgearray is not from source
-		for (int i=0; i<G->numedges; i++)
-			if (!deletededges[i]) {
-				//printf("edge %d->%d remains\n",G->edgearray[i]->src,G->edgearray[i]->dest);
-				if (sourcepos == -1 && G->edgearray[i]->src==0)
-					sourcepos = numedges;
-				edgearray[numedges++]=G->edgearray[i];
-			}
-		struct Edge *tmp = edgearray[sourcepos];
-		edgearray[sourcepos]=edgearray[0];
-		edgearray[0]=tmp;
-
-		// create the new DAG
-		newdag = edgearray2DAG(edgearray, numedges, G->numnodes-1, 0);
-		//writeDAGtofile(newdag);
-		free(edgearray);
-		//freeDAG(G);
-		//G = newdag;
-		//printf("G is now %p\n",G);
-		//return newdag;
-		ret = -1; // in order to return newdag
-	}
-	
+		compactDAG(G, deletededges); // if at least one edge is deleted, we update the DAG in place
 	
-	free(deletededges);
-	free(deletednodes);
-	free(numdeletedout);
+	dagfree(G, deletededges);
+	dagfree(G, deletednodes);
+	dagfree(G, numdeletedout);
 
 	if (ret==-1)
-		return newdag; // should be NULL if no newdag is constructed
+		return NULL; // source of DAG lost connection to sink
 	else
 		return G;
 }
@@ -748,17 +1004,17 @@ double computeFlowGreedy(struct DAG G)
     int *ptr; // array with pointers to the current interaction per edge
     int minedge; 
     double flow;
-    elem *heapq = (elem *)malloc((G.numedges)*sizeof(elem)); //array of heap elements for merging edges
+    elem *heapq = (elem *)dagalloc(&G, (G.numedges+1)*sizeof(elem)); //array of heap elements for merging edges
     elem tempE; // dummy element, used for dequeueing
     int numheapqelem = 0; //number of elements in heapq
     
-    buffer = (double *)malloc(G.numnodes*sizeof(double));
+    buffer = (double *)dagalloc(&G, G.numnodes*sizeof(double));
     for(i=1;i<G.numnodes;i++) {
         buffer[i]=0.0; // initially, all buffers, except the buffer of the source are 0
     }
     buffer[0]=MAXFLOW; // a very big number, make sure MAXFLOW is larger than the sum of all flows on all interactions in the DAG
 
-    ptr = (int *)malloc((G.numedges)*sizeof(int)); // it could be faster if we used calloc 
+    ptr = (int *)dagalloc(&G, (G.numedges+1)*sizeof(int)); // it could be faster if we used calloc 
     for(i=0;i<G.numedges;i++) {
         ptr[i]=0;
         enqueue(G.edgearray[i]->inter[ptr[i]].timestamp, i, heapq, &numheapqelem);
@@ -797,9 +1053,66 @@ double computeFlowGreedy(struct DAG G)
     flow = buffer[G.numnodes-1];
     //printf("flow at node %d is %f\n",G.numnodes-1, flow);
 
-	free(buffer);
-	free(ptr);
-	free(heapq);
+	dagfree(&G, buffer);
+	dagfree(&G, ptr);
+	dagfree(&G, heapq);
+	
+    return flow;
+}
+
+// same as computeFlowGreedy BUT
+// edges are merged with a cache-aligned 4-ary heap (see minheap.h) and the top edge is loaded once per step;
+// interactions with equal timestamps on different edges are taken in the order the 4-ary heap gives them,
+// so the flow may differ from computeFlowGreedy on DAGs with simultaneous interactions
+double computeFlowGreedyHeap4(struct DAG G)
+{
+    int i,j,k;
+    double *buffer; // array of buffers, one for each node of the DAG
+    int *ptr; // array with pointers to the current interaction per edge
+    int minedge; 
+    double flow;
+    elem *heapblock = (elem *)dagalloc(&G, (G.numedges+HEAP4SLACK+1)*sizeof(elem));
+    elem *heapq = alignheap4(heapblock); //4-ary heap of edges for merging their interactions (see minheap.h)
+    elem tempE; // dummy element, used for dequeueing
+    int numheapqelem = 0; //number of elements in heapq
+    
+    buffer = (double *)dagalloc(&G, G.numnodes*sizeof(double));
+    for(i=1;i<G.numnodes;i++) {
+        buffer[i]=0.0; // initially, all buffers, except the buffer of the source are 0
+    }
+    buffer[0]=MAXFLOW; // a very big number, make sure MAXFLOW is larger than the sum of all flows on all interactions in the DAG
+
+    ptr = (int *)dagalloc(&G, (G.numedges+1)*sizeof(int)); // it could be faster if we used calloc 
+    for(i=0;i<G.numedges;i++) {
+        ptr[i]=0;
+        heapq[numheapqelem].value = G.edgearray[i]->inter[ptr[i]].timestamp;
+        heapq[numheapqelem++].idx = i;
+        //printf("edgeid=%d (%d->%d, %f, %f)\n",i,G.edgearray[i]->src,G.edgearray[i]->dest,G.edgearray[i]->inter[ptr[i]].timestamp,G.edgearray[i]->inter[ptr[i]].quantity);
+    }
+    heapify4(heapq, numheapqelem);
+    //print_heap(heapq, numheapqelem);
+
+    //merge interactions on edges and compute flow
+    while (numheapqelem) {
+    	//printf("top edge(%d): %d->%d, (%f,%f)\n",heapq[0].idx,G.edgearray[heapq[0].idx]->src,G.edgearray[heapq[0].idx]->dest,heapq[0].value,G.edgearray[heapq[0].idx]->inter[ptr[heapq[0].idx]].quantity);
+        minedge = heapq[0].idx;
+        struct Edge *e = G.edgearray[minedge]; // edge of top element
+        flow = (buffer[e->src] < e->inter[ptr[minedge]].quantity) ? buffer[e->src] : e->inter[ptr[minedge]].quantity ;
+        //printf("flow=%f\n",flow);
+        buffer[e->src] -= flow;
+        buffer[e->dest] += flow;
+        if (++ptr[minedge]<e->numinter) // next interaction of edge replaces it in the heap
+        	replacetop4(e->inter[ptr[minedge]].timestamp, minedge, heapq, &numheapqelem);
+        else
+        	dequeue4(&tempE, heapq, &numheapqelem);
+    }
+
+    flow = buffer[G.numnodes-1];
+    //printf("flow at node %d is %f\n",G.numnodes-1, flow);
+
+	dagfree(&G, buffer);
+	dagfree(&G, ptr);
+	dagfree(&G, heapblock);
 	
     return flow;
 }
@@ -871,7 +1184,7 @@ double computeFlowGreedyWithInter(struct DAG G, struct Interaction **inter, int
     int minedge;
     double flow;
     int totinter = 0; // for mem allocation only
-    elem *heapq = (elem *)malloc((G.numedges)*sizeof(elem)); //array of heap elements for merging edges
+    elem *heapq = (elem *)dagalloc(&G, (G.numedges+1)*sizeof(elem)); //array of heap elements for merging edges
     elem tempE; // dummy element, used for dequeueing
     int numheapqelem = 0; //number of elements in heapq
     
@@ -883,13 +1196,13 @@ double computeFlowGreedyWithInter(struct DAG G, struct Interaction **inter, int
     //printf("total no of interactions into sink=%d\n",totinter);
     *inter = (struct Interaction *)malloc(totinter*sizeof(struct Interaction));
     
-    buffer = (double *)malloc(G.numnodes*sizeof(double));
+    buffer = (double *)dagalloc(&G, G.numnodes*sizeof(double));
     for(i=1;i<G.numnodes;i++) {
         buffer[i]=0.0; // initially, all buffers, except the buffer of the source are 0
     }
     buffer[0]=MAXFLOW; // a very big number, make sure MAXFLOW is larger than the sum of all flows on all interactions in the DAG
 
-    ptr = (int *)malloc((G.numedges)*sizeof(int)); // it could be faster if we used calloc 
+    ptr = (int *)dagalloc(&G, (G.numedges+1)*sizeof(int)); // it could be faster if we used calloc 
     for(i=0;i<G.numedges;i++) {
         ptr[i]=0;
         enqueue(G.edgearray[i]->inter[ptr[i]].timestamp, i, heapq, &numheapqelem);
@@ -936,326 +1249,443 @@ double computeFlowGreedyWithInter(struct DAG G, struct Interaction **inter, int
     //for (i=0; i<*numinter; i++)
     //	printf("%f %f\n",(*inter)[i].timestamp, (*inter)[i].quantity);
 
-	free(buffer);
-	free(ptr);
-	free(heapq);
+	dagfree(&G, buffer);
+	dagfree(&G, ptr);
+	dagfree(&G, heapq);
 	
     return flow;
 }
 
+// order-preserving map of a timestamp to an unsigned integer (used as radix sort key)
+static inline uint64_t timeKey(double t)
+{
+	uint64_t k;
+	memcpy(&k,&t,sizeof(k));
+	return (k>>63) ? ~k : k|((uint64_t)1<<63); // negative values: all bits flipped
+}
 
-// computes the flow throughout a DAG from its source (node at position 0) 
-// to its sink (node at position G.numnodes-1)
-// converts problem to LP computation problem
-// each interaction (except those on outgoing edges from the source) is a variable
-// see the paper for details on the formulation
-double computeFlowLP(struct DAG G)
+// stable sort of ev[0..n-1] by timestamp; tmp has room for n events
+// LSD radix sort with one byte per pass; passes where all keys have the same byte are skipped
+// (usually most of them, as timestamps share exponent and low mantissa bytes)
+// returns the array (ev or tmp) that holds the sorted events
+static struct FlowEvent *sortEvents(struct FlowEvent *ev, struct FlowEvent *tmp, int n)
 {
-    int i,j,k;
-    double flow;
+	int i,b;
+	int count[8][256];
+
+	if (n < RADIXMIN) { // few events: insertion sort
+		for (i=1; i<n; i++) {
+			struct FlowEvent e = ev[i];
+			int j = i;
+			for (; j>0 && ev[j-1].timestamp > e.timestamp; j--)
+				ev[j] = ev[j-1];
+			ev[j] = e;
+		}
+		return ev;
+	}
+	memset(count,0,sizeof(count));
+	for (i=0; i<n; i++) {
+		uint64_t k = timeKey(ev[i].timestamp);
+		for (b=0; b<8; b++)
+			count[b][(k>>(8*b))&255]++;
+	}
+	for (b=0; b<8; b++) {
+		if (count[b][(timeKey(ev[0].timestamp)>>(8*b))&255] == n)
+			continue;
+		int pos = 0;
+		for (int d=0; d<256; d++) {
+			int c = count[b][d];
+			count[b][d] = pos;
+			pos += c;
+		}
+		for (i=0; i<n; i++)
+			tmp[count[b][(timeKey(ev[i].timestamp)>>(8*b))&255]++] = ev[i];
+		struct FlowEvent *swap = ev;
+		ev = tmp;
+		tmp = swap;
+	}
+	return ev;
+}
+
+// returns the interactions of edgearray[0..numedges-1] as events sorted by time (ties by edge
+// position, then by position in the edge, i.e. the order in which find_minedge visits them)
+// the array is allocated with dagalloc if G is not NULL, with malloc otherwise; *numevents holds its size
+struct FlowEvent *buildTimeline(struct DAG *G, struct Edge **edgearray, int numedges, int *numevents)
+{
+	int i,j;
+	int n = 0;
+
+	for (i=0; i<numedges; i++)
+		n += edgearray[i]->numinter;
+	struct FlowEvent *ev = (struct FlowEvent *)((G != NULL) ? dagalloc(G, (n+1)*sizeof(struct FlowEvent)) : malloc((n+1)*sizeof(struct FlowEvent)));
+	struct FlowEvent *tmp = (struct FlowEvent *)((G != NULL) ? dagalloc(G, (n+1)*sizeof(struct FlowEvent)) : malloc((n+1)*sizeof(struct FlowEvent)));
+	n = 0;
+	for (i=0; i<numedges; i++) { // edge after edge, so that the stable sort breaks ties by edge position
+		for (j=0; j<edgearray[i]->numinter; j++) {
+			ev[n].timestamp = edgearray[i]->inter[j].timestamp;
+			ev[n].quantity = edgearray[i]->inter[j].quantity;
+			ev[n].src = edgearray[i]->src;
+			ev[n++].dest = edgearray[i]->dest;
+		}
+	}
+	struct FlowEvent *sorted = sortEvents(ev, tmp, n);
+	struct FlowEvent *other = (sorted==ev) ? tmp : ev;
+	if (G != NULL)
+		dagfree(G, other);
+	else
+		free(other);
+	*numevents = n;
+	return sorted;
+}
+
+// same as computeFlowGreedy BUT
+// the interactions are sorted once (see buildTimeline) and the buffers are updated in one pass
+// over them, without a heap; ties are visited in edge order, as in computeFlowGreedyOld
+// (the heap of computeFlowGreedy may visit them in another order and give a different flow)
+double computeFlowGreedyTimeline(struct DAG G)
+{
+	int i;
+	int numevents;
+	double flow;
+	struct FlowEvent *ev = buildTimeline(&G, G.edgearray, G.numedges, &numevents);
+	double *buffer = (double *)dagalloc(&G, G.numnodes*sizeof(double)); // array of buffers, one for each node of the DAG
+
+	for (i=1; i<G.numnodes; i++)
+		buffer[i] = 0.0; // initially, all buffers, except the buffer of the source are 0
+	buffer[0] = MAXFLOW; // a very big number, make sure MAXFLOW is larger than the sum of all flows on all interactions in the DAG
+
+	for (i=0; i<numevents; i++) {
+		flow = (buffer[ev[i].src] < ev[i].quantity) ? buffer[ev[i].src] : ev[i].quantity;
+		buffer[ev[i].src] -= flow;
+		buffer[ev[i].dest] += flow;
+	}
+	flow = buffer[G.numnodes-1];
+
+	dagfree(&G, buffer);
+	dagfree(&G, ev);
+	return flow;
+}
+
+// same as computeFlowGreedyTimeline BUT
+// records all incoming interactions to sink, which accumulate to total flow
+// into variable **inter; *numinter will hold the number of interactions 
+double computeFlowGreedyTimelineWithInter(struct DAG G, struct Interaction **inter, int *numinter)
+{
+	int i;
+	int numevents;
+	double flow;
+	int totinter = 0; // for mem allocation only
+	int sink = G.numnodes-1; //id of sink
+
+	*numinter = 0;
+	for (i=0; i<G.node[sink].numinc; i++)
+		totinter += G.edgearray[G.node[sink].incedges[i]]->numinter;
+	*inter = (struct Interaction *)malloc((totinter+1)*sizeof(struct Interaction));
+
+	struct FlowEvent *ev = buildTimeline(&G, G.edgearray, G.numedges, &numevents);
+	double *buffer = (double *)dagalloc(&G, G.numnodes*sizeof(double));
+	for (i=1; i<G.numnodes; i++)
+		buffer[i] = 0.0;
+	buffer[0] = MAXFLOW;
+
+	for (i=0; i<numevents; i++) {
+		flow = (buffer[ev[i].src] < ev[i].quantity) ? buffer[ev[i].src] : ev[i].quantity;
+		buffer[ev[i].src] -= flow;
+		buffer[ev[i].dest] += flow;
+		if (ev[i].dest==sink && flow>0) { // record non-zero-flow incoming interactions to sink
+			(*inter)[*numinter].timestamp = ev[i].timestamp;
+			(*inter)[(*numinter)++].quantity = flow;
+		}
+	}
+	flow = buffer[sink];
+
+	dagfree(&G, buffer);
+	dagfree(&G, ev);
+	return flow;
+}
+
 
-    lprec *lp;
-    int *colno = NULL,ret = 0;
+//compare two interactions of a node by time; used by qsort call in function buildFlowLP
+int compTimedIndex(const void *a, const void *b) {
+	if (((struct TimedIndex *)a)->timestamp > ((struct TimedIndex *)b)->timestamp)
+    	return 1;
+  	else if (((struct TimedIndex *)a)->timestamp < ((struct TimedIndex *)b)->timestamp)
+    	return -1;
+  	else
+    	return 0; 
+}
+
+// builds the LP model of the flow problem on DAG G (used by computeFlowLPTimed and computeFlowLPWithInter)
+// each variable x_i (interaction i leaving node u) is bounded by the quantity of i, and
+// LPMODEL_INTER: x_i + (outgoing variables of u before i) - (incoming variables of u before i) <= (incoming flow of u from the source before i)
+// LPMODEL_SHARED: the same, but the outgoing variables of u at the time of i are added as well; all interactions
+// of u at one time then have the same row, so it is added once per distinct time (as in the max-flow of maxflow.h)
+// the interactions of every node are sorted by time, so that these variables form a prefix
+// of the node's list and each row holds only its nonzeros
+// returns 0 on success, error code otherwise (the model should be freed with freeFlowLP in both cases)
+int buildFlowLP(struct DAG G, int model, struct LPModel *m)
+{
+    int i,j,k;
+    int ret = 0;
+    int *colno = NULL;
     REAL *row = NULL;
-    int Ncol=0; /* total number of variables, excludes those from source*/
-    int totinter=0; /* total number of interactions, including those from source*/
-    int curinter=0;
-    int l;
-    struct CompleteInteraction *inters; /* complete list of interactions in DAG */
-    
-    int *numincinters; // number of incoming interactions per node
-    int **incinters; // list of indexes to inters for each node (incoming interactions)
-    int *numoutinters; // number of incoming interactions per node
-    int **outinters; // list of indexes to inters for each node (incoming interactions)
-    
-    int *map; // map[i] = variable-id corresponding to interaction i
-    
-    clock_t t;
-    double time_taken;
 
-    numincinters = (int *)malloc(G.numnodes*sizeof(int));
-    incinters = (int **)malloc(G.numnodes*sizeof(int *));
-    numoutinters = (int *)malloc(G.numnodes*sizeof(int));
-    outinters = (int **)malloc(G.numnodes*sizeof(int *));
-    for (i=0; i<G.numnodes;i++) {
-        numincinters[i]=0;
-        numoutinters[i]=0;
-    }
-    
+    int *incstart; // incoming interactions of node u are incinters[incstart[u]..incstart[u+1]-1]
+    int *outstart; // outgoing interactions of node u are outinters[outstart[u]..outstart[u+1]-1]
+    struct TimedIndex *incinters; // sorted by time per node
+    struct TimedIndex *outinters; // sorted by time per node
+    int *numprevout; // numprevout[i] = number of outgoing interactions of the same node in the row of interaction i (-1: no row)
+    int *numprevinc; // numprevinc[i] = number of incoming interactions of the same node before interaction i
+    double *fromsource; // fromsource[i] = incoming flow from the source before interaction i
+
+    m->lp = NULL;
+    m->Ncol = 0;
+    m->totinter = 0;
+
+    incstart = (int *)calloc(G.numnodes+1,sizeof(int));
+    outstart = (int *)calloc(G.numnodes+1,sizeof(int));
+
     /* count number of interactions and variables */
     for (i=0; i<G.numedges;i++) {
-        //printf("%d %d\n",G.edgearray[i]->src,G.edgearray[i]->dest);
-        totinter += G.edgearray[i]->numinter;
-        numincinters[G.edgearray[i]->dest]+=G.edgearray[i]->numinter;
-        numoutinters[G.edgearray[i]->src]+=G.edgearray[i]->numinter;
+        m->totinter += G.edgearray[i]->numinter;
+        incstart[G.edgearray[i]->dest+1]+=G.edgearray[i]->numinter;
+        outstart[G.edgearray[i]->src+1]+=G.edgearray[i]->numinter;
     }
     for (i=0; i<G.numnodes;i++) {
-        incinters[i]=(int *)malloc(numincinters[i]*sizeof(int) );
-        numincinters[i] = 0;
-        outinters[i]=(int *)malloc(numoutinters[i]*sizeof(int) );
-        numoutinters[i] = 0;
+        incstart[i+1] += incstart[i];
+        outstart[i+1] += outstart[i];
     }
-    
-    inters = (struct CompleteInteraction *)malloc(totinter*sizeof(struct CompleteInteraction));
-    map = (int  *)malloc(totinter*sizeof(int));
+
+    m->inters = (struct CompleteInteraction *)malloc(m->totinter*sizeof(struct CompleteInteraction));
+    m->map = (int *)malloc(m->totinter*sizeof(int)); //map interaction-id to variable-id (from 0)
+    m->revmap = (int *)malloc(m->totinter*sizeof(int)); //map variable-id to interaction-id
+    incinters = (struct TimedIndex *)malloc(m->totinter*sizeof(struct TimedIndex));
+    outinters = (struct TimedIndex *)malloc(m->totinter*sizeof(struct TimedIndex));
+    numprevout = (int *)malloc(m->totinter*sizeof(int));
+    numprevinc = (int *)malloc(m->totinter*sizeof(int));
+    fromsource = (double *)malloc(m->totinter*sizeof(double));
 
     int n=0;
     for (i=0; i<G.numedges;i++)
         for (j=0; j<G.edgearray[i]->numinter; j++) {
-            incinters[G.edgearray[i]->dest][numincinters[G.edgearray[i]->dest]++] = n;
-            outinters[G.edgearray[i]->src][numoutinters[G.edgearray[i]->src]++] = n;
-            inters[n].src = G.edgearray[i]->src;
-            if (G.edgearray[i]->src==0)
-                map[n] = -1;
-            else
-                map[n] = Ncol++;
-            
-            inters[n].dest = G.edgearray[i]->dest;
-            inters[n].timestamp = G.edgearray[i]->inter[j].timestamp;
-            inters[n++].quantity = G.edgearray[i]->inter[j].quantity;
+            int src = G.edgearray[i]->src;
+            int dest = G.edgearray[i]->dest;
+            double ts = G.edgearray[i]->inter[j].timestamp;
+            incinters[incstart[dest]].timestamp = ts;
+            incinters[incstart[dest]++].idx = n;
+            outinters[outstart[src]].timestamp = ts;
+            outinters[outstart[src]++].idx = n;
+            m->inters[n].src = src;
+            if (src==0)
+                m->map[n] = -1;
+            else {
+                m->map[n] = m->Ncol;
+                m->revmap[m->Ncol] = n;
+                m->Ncol++;
+            }
+            m->inters[n].dest = dest;
+            m->inters[n].timestamp = ts;
+            m->inters[n++].quantity = G.edgearray[i]->inter[j].quantity;
         }
-    
-    //printf("Ncol=%d\n",Ncol);
-    
-    /*
-    //print interactions
-    for (i=0;i<totinter;i++) {
-        printf("%d %d %f %f\n",inters[i].src,inters[i].dest,inters[i].timestamp,inters[i].quantity);
+    for (i=G.numnodes; i>0; i--) { // the fill loop moved starts to the ends: shift back
+        incstart[i] = incstart[i-1];
+        outstart[i] = outstart[i-1];
     }
-
-    //print map
-    for (i=0;i<totinter;i++) {
-        printf("%d %d\n",i, map[i]);
+    incstart[0] = 0;
+    outstart[0] = 0;
+
+    // for every outgoing interaction i of node u, find the prefixes of u's lists that precede i
+    for (i=1; i<G.numnodes;i++) {
+        struct TimedIndex *out = outinters+outstart[i];
+        struct TimedIndex *inc = incinters+incstart[i];
+        int numout = outstart[i+1]-outstart[i];
+        int numinc = incstart[i+1]-incstart[i];
+        qsort(out, numout, sizeof(struct TimedIndex), compTimedIndex);
+        qsort(inc, numinc, sizeof(struct TimedIndex), compTimedIndex);
+        int p = 0; // out[0..p-1] are before current interaction (LPMODEL_SHARED: or at its time)
+        int q = 0; // inc[0..q-1] are before current interaction
+        double srcflow = 0;
+        for (j=0; j<numout; j++) {
+            double ts = out[j].timestamp;
+            while (p<numout && (out[p].timestamp<ts || (model==LPMODEL_SHARED && out[p].timestamp==ts)))
+                p++;
+            while (q<numinc && inc[q].timestamp<ts) {
+                if (m->inters[inc[q].idx].src==0)
+                    srcflow += m->inters[inc[q].idx].quantity;
+                q++;
+            }
+            if (model==LPMODEL_SHARED) // the last interaction of a time has the row of all
+                numprevout[out[j].idx] = (j==p-1) ? p : -1;
+            else
+                numprevout[out[j].idx] = p;
+            numprevinc[out[j].idx] = q;
+            fromsource[out[j].idx] = srcflow;
+        }
     }
-    
-    printf("number of variables=%d\n",Ncol);
-
-    //print interactions per node
-    for (i=0;i<G.numnodes;i++) {
-        printf("node %d incoming interactions:\n",i);
-        for (j=0;j<numincinters[i];j++)
-            printf("%d %d %f %f\n",inters[incinters[i][j]].src,inters[incinters[i][j]].dest,inters[incinters[i][j]].timestamp,inters[incinters[i][j]].quantity);
-        printf("node %d outgoing interactions:\n",i);
-        for (j=0;j<numoutinters[i];j++)
-            printf("%d %d %f %f\n",inters[outinters[i][j]].src,inters[outinters[i][j]].dest,inters[outinters[i][j]].timestamp,inters[outinters[i][j]].quantity);
 
-    }
-    */
-  
-    
     /* We will build the model row by row */
-    lp = make_lp(0, Ncol);
-    
-    
-    if(lp == NULL)
+    m->lp = make_lp(0, m->Ncol);
+    if(m->lp == NULL)
       ret = 1; /* couldn't construct a new model... */
 
     if(ret == 0) {
       /* let us name our variables. Not required, but can be useful for debugging */
-        for (i=0;i<Ncol;i++) {
-        	char snum[10];
+        for (i=0;i<m->Ncol;i++) {
+        	char snum[16];
         	sprintf(snum, "x%d", i+1);
-            set_col_name(lp, i+1, snum);
+            set_col_name(m->lp, i+1, snum);
         }
       /* create space large enough for one row */
-      colno = (int *) malloc(Ncol * sizeof(*colno));
-      row = (REAL *) malloc(Ncol * sizeof(*row));
+      colno = (int *) malloc((m->Ncol+1) * sizeof(*colno));
+      row = (REAL *) malloc((m->Ncol+1) * sizeof(*row));
       if((colno == NULL) || (row == NULL))
         ret = 2;
     }
-    
 
     if(ret == 0) {
-        set_add_rowmode(lp, TRUE);  /* makes building the model faster if it is done rows by row */
-            
-//        curinter =0; //current interaction
-        for (i=0; i<totinter; i++) {
-            if (inters[i].src != 0) {
-                //printf("%d\n",i);
-                /* two constraints per interaction*/
-                
-                /* first constraint is upper bound based on flow on interaction*/
-                j = 0;
-                
-                for(l=0; l<map[i]; l++) {
-                    colno[j] = l+1; /* first column */
-                    row[j++] = 0; /* coefficient */
+        set_add_rowmode(m->lp, TRUE);  /* makes building the model faster if it is done rows by row */
+
+        for (i=0; i<m->totinter && ret==0; i++) {
+            if (m->map[i] == -1 || numprevout[i] == -1)
+                continue;
+            /* constraint based on feasible flow transfer*/
+            int u = m->inters[i].src;
+            j = 0;
+            if (model==LPMODEL_INTER) { // i is not in the prefix
+                colno[j] = m->map[i]+1;
+                row[j++] = 1;
+            }
+            for (k=outstart[u]; k<outstart[u]+numprevout[i]; k++) {
+                colno[j] = m->map[outinters[k].idx]+1;
+                row[j++] = 1;
+            }
+            for (k=incstart[u]; k<incstart[u]+numprevinc[i]; k++)
+                if (m->map[incinters[k].idx] != -1) {
+                    colno[j] = m->map[incinters[k].idx]+1;
+                    row[j++] = -1;
                 }
 
-                colno[j] = map[i]+1; /* second column */
-                row[j++] = 1; /* coefficient */
-                l++;
-
-                for(; l<Ncol; l++) {
-                    colno[j] = l+1; /* first column */
-                    row[j++] = 0; /* coefficient */
-                }
-                
-                /*
-                printf("basic constraint:\n");
-                if (j!=Ncol)
-                    printf("problem\n");
-                else
-                    for (int s=0; s<Ncol; s++)
-                        printf("colno:%d row:%f\n",colno[s],row[s]);
-                printf("less than:%f\n",inters[i].quantity);
-                */
-                
-                /* add the row to lpsolve */
-                if(!add_constraintex(lp, Ncol, row, colno, LE, inters[i].quantity))
-                  ret = 3;
-
-                //printf("ok\n");
-                /* second constraint is based on feasible flow transfer*/
-                //initialize all
-                for(j=0; j<Ncol; j++) {
-                    colno[j] = j+1;
-                    row[j] = 0;
-                }
-            
-                //set variable corresponding to interaction
-                colno[map[i]] = map[i]+1;
-                row[map[i]] = 1;
-
-                //consider other interactions
-                double fromsource=0;
-                for (int s=0; s<totinter; s++) {
-                    if (s==i) continue;
-                    if (inters[s].src==0 && inters[s].dest==inters[i].src && inters[s].timestamp<inters[i].timestamp)
-                        fromsource+=inters[s].quantity;
-                    else { // check incoming/outgoing interactions to/from src
-                        if (inters[s].src!=0 && inters[s].dest==inters[i].src && inters[s].timestamp<inters[i].timestamp) {
-                            colno[map[s]]=map[s]+1;
-                            row[map[s]] = -1;
-                        }
-                        else if (inters[s].src==inters[i].src && inters[s].timestamp<inters[i].timestamp) {
-                            colno[map[s]]=map[s]+1;
-                            row[map[s]] = 1;
-                        }
-                    }
-                }
-                
-                /*
-                printf("other constraint:\n");
-                for (int s=0; s<Ncol; s++)
-                        printf("colno:%d row:%f\n",colno[s],row[s]);
-                printf("less than:%f\n",fromsource);
-                */
-                
-                /* add the row to lpsolve */
-                if(!add_constraintex(lp, j, row, colno, LE, fromsource))
-                  ret = 3;
-
-            }
+            /* add the row to lpsolve */
+            if(!add_constraintex(m->lp, j, row, colno, LE, fromsource[i]))
+              ret = 3;
         }
     }
-    
- 
-    if(ret == 0) {
-		set_add_rowmode(lp, FALSE); /* rowmode should be turned off again when done building the model */
 
-		/* set the objective function */
-		
-		//initalization
-		for (i=0; i<Ncol; i++) {
-			colno[i] = i+1; 
-			row[i] = 0;
-		}
+    if(ret == 0) {
+		set_add_rowmode(m->lp, FALSE); /* rowmode should be turned off again when done building the model */
+
+		/* upper bound of each variable is the flow on its interaction */
+		for (i=0; i<m->totinter; i++)
+			if (m->map[i] != -1)
+				set_upbo(m->lp, m->map[i]+1, m->inters[i].quantity);
+
+		/* set the objective function: variables corresponding to interactions that have as destination the sink node */
+		j = 0;
+		for (i=0; i<m->totinter; i++)
+            if (m->map[i] != -1 && m->inters[i].dest == G.numnodes-1) {
+				colno[j] = m->map[i]+1;
+            	row[j++] = 1;
+            }
 
-		//now set variables corresponding to interactions that have as destination the sink node
-		for (i=0; i<totinter; i++)
-            if (inters[i].src != 0 && inters[i].dest == G.numnodes-1)
-            	row[map[i]]=1;
-            	
-        /*
-        printf("objective function for maximization:\n");
-		for (int i=0; i<Ncol; i++)
-				printf("colno:%d row:%f\n",colno[i],row[i]);
-		*/
-		
 		/* set the objective in lpsolve */
-		if(!set_obj_fnex(lp, Ncol, row, colno))
+		if(!set_obj_fnex(m->lp, j, row, colno))
 		  ret = 4;
   	}
-  
 
     if(ret == 0) {
       /* set the object direction to maximize */
-      set_maxim(lp);
-
-      /* just out of curioucity, now show the model in lp format on screen */
-      /* this only works if this is a console application. If not, use write_lp and a filename */
-      //write_LP(lp, stdout);
-      /* write_lp(lp, "model.lp"); */
+      set_maxim(m->lp);
 
       /* I only want to see important messages on screen while solving */
-      set_verbose(lp, IMPORTANT);
+      set_verbose(m->lp, IMPORTANT);
+    }
+
+    if(row != NULL)
+      free(row);
+    if(colno != NULL)
+      free(colno);
+    free(incstart);
+    free(outstart);
+    free(incinters);
+    free(outinters);
+    free(numprevout);
+    free(numprevinc);
+    free(fromsource);
+
+    return ret;
+}
+
+// frees the LP model built by buildFlowLP
+void freeFlowLP(struct LPModel *m)
+{
+    if(m->lp != NULL) {
+      /* clean up such that all used memory by lpsolve is freed */
+      delete_lp(m->lp);
+      m->lp = NULL;
+    }
+    free(m->inters);
+    free(m->map);
+    free(m->revmap);
+}
+
+// computes the flow throughout a DAG from its source (node at position 0) 
+// to its sink (node at position G.numnodes-1)
+// converts problem to LP computation problem
+// each interaction (except those on outgoing edges from the source) is a variable
+// see the paper for details on the formulation
+double computeFlowLP(struct DAG G)
+{
+    int optimal;
+
+    return computeFlowLPTimed(G, LPMODEL_INTER, 0, &optimal);
+}
+
+// same as computeFlowLP with model LPMODEL_SHARED
+double computeFlowLPShared(struct DAG G)
+{
+    int optimal;
+
+    return computeFlowLPTimed(G, LPMODEL_SHARED, 0, &optimal);
+}
+
+// same as computeFlowLP with LP model model, but lp_solve gives up after timeout seconds (0: no limit)
+// *optimal is 1 if the LP was solved; else the flow of the best solution found in time is returned
+// (a lower bound of the flow), or -1 if there is none
+double computeFlowLPTimed(struct DAG G, int model, long timeout, int *optimal)
+{
+    int i;
+    double flow = -1;
+    int ret;
+    struct LPModel m;
+
+    *optimal = 0;
+    ret = buildFlowLP(G, model, &m);
 
+    if(ret == 0) {
+      if (timeout > 0)
+        set_timeout(m.lp, timeout);
       /* Now let lpsolve calculate a solution */
-      //t = clock();    
-      ret = solve(lp);
-      //t = clock() - t;
-      //time_taken = ((double)t)/CLOCKS_PER_SEC;
-      //printf("Total time of lpsolve: %f seconds\n", time_taken);
-      
-      if(ret == OPTIMAL)
+      ret = solve(m.lp);
+      if(ret == OPTIMAL) {
+        *optimal = 1;
         ret = 0;
-      else
+      }
+      else if(ret != SUBOPTIMAL) // SUBOPTIMAL: out of time, but a solution was found
         ret = 5;
     }
-        
-  
-    if(ret == 0) {
-       /* a solution is calculated, now lets get some results */
-
-       /* objective value */
-       //printf("Objective value: %f\n", get_objective(lp));
 
-       /* variable values */
-       //get_variables(lp, row);
-       
-       //for(j = 0; j < Ncol; j++)
-       //  printf("%s: %f\n", get_col_name(lp, j + 1), row[j]);
-
-       /* we are done now */
-       
+    if(ret == 0 || ret == SUBOPTIMAL) {
        // total flow is objective value + total incoming flow directly from source to sink
 		double directflow =0;
-		//now set variables corresponding to interactions that have as destination the sink node
-		for (i=0; i<totinter; i++)
-			if (inters[i].src == 0 && inters[i].dest == G.numnodes-1)
-				directflow+=inters[i].quantity;
-		flow = get_objective(lp)+directflow;
-		//printf("Total flow: %f\n", get_objective(lp)+directflow);
+		for (i=0; i<m.totinter; i++)
+			if (m.inters[i].src == 0 && m.inters[i].dest == G.numnodes-1)
+				directflow+=m.inters[i].quantity;
+		flow = get_objective(m.lp)+directflow;
+		//printf("Total flow: %f\n", get_objective(m.lp)+directflow);
      }
-     
-     
-
-     /* free allocated memory */
-     if(row != NULL)
-       free(row);
-     if(colno != NULL)
-       free(colno);
 
-     if(lp != NULL) {
-       /* clean up such that all used memory by lpsolve is freed */
-       delete_lp(lp);
-     }
-     
-     
-     for (i=0; i<G.numnodes;i++) {
-        free(incinters[i]);
-        free(outinters[i]);
-     }
-     free(numincinters);
-     free(incinters);
-     free(numoutinters);
-     free(outinters);
-	 free(inters);
-	 free(map);
-	 
+     freeFlowLP(&m);
      return(flow);
-    
 }
 
 //compare two interactions by time; used by qsort call in function computeFlowLPWithInter
@@ -1272,336 +1702,55 @@ int compInter(const void *a, const void *b) {
 // returns incoming interactions to sink, which accumulate to total flow
 double computeFlowLPWithInter(struct DAG G, struct Interaction **inter, int *numinter)
 {
-    int i,j,k;
+    int i,j;
     double flow;
-
-    lprec *lp;
-    int *colno = NULL,ret = 0;
+    int ret;
+    struct LPModel m;
     REAL *row = NULL;
-    int Ncol=0; /* total number of variables, excludes those from source*/
-    int totinter=0; /* total number of interactions, including those from source*/
-    int curinter=0;
-    int l;
-    struct CompleteInteraction *inters; /* complete list of interactions in DAG */
-    
-    int *numincinters; // number of incoming interactions per node
-    int **incinters; // list of indexes to inters for each node (incoming interactions)
-    int *numoutinters; // number of incoming interactions per node
-    int **outinters; // list of indexes to inters for each node (incoming interactions)
-    
-    int *map; // map[i] = variable-id corresponding to interaction i
-    int *revmap; // revmap[i] = interaction-id corresponding to variable i
-    
-    clock_t t;
-    double time_taken;
-    
-    //double *timestamps; //maps variables to timestamps of corresponding interactions
 
-    //initialize returned data
     int ti = 0; // for mem allocation only
     *numinter = 0; 
     int sink = G.numnodes-1; //id of sink
     for (i=0; i<G.node[sink].numinc; i++)
     	ti += G.edgearray[G.node[sink].incedges[i]]->numinter;
-    //printf("total no of interactions into sink=%d\n",ti);
     *inter = (struct Interaction *)malloc(ti*sizeof(struct Interaction));
-    
-    numincinters = (int *)malloc(G.numnodes*sizeof(int));
-    incinters = (int **)malloc(G.numnodes*sizeof(int *));
-    numoutinters = (int *)malloc(G.numnodes*sizeof(int));
-    outinters = (int **)malloc(G.numnodes*sizeof(int *));
-    for (i=0; i<G.numnodes;i++) {
-        numincinters[i]=0;
-        numoutinters[i]=0;
-    }
-    
-    /* count number of interactions and variables */
-    for (i=0; i<G.numedges;i++) {
-        //printf("%d %d\n",G.edgearray[i]->src,G.edgearray[i]->dest);
-        totinter += G.edgearray[i]->numinter;
-        numincinters[G.edgearray[i]->dest]+=G.edgearray[i]->numinter;
-        numoutinters[G.edgearray[i]->src]+=G.edgearray[i]->numinter;
-        //if (G.edgearray[i]->src != 0)
-        //    Ncol += G.edgearray[i]->numinter;
-    }
-    for (i=0; i<G.numnodes;i++) {
-        incinters[i]=(int *)malloc(numincinters[i]*sizeof(int) );
-        numincinters[i] = 0;
-        outinters[i]=(int *)malloc(numoutinters[i]*sizeof(int) );
-        numoutinters[i] = 0;
-    }
-    
-    inters = (struct CompleteInteraction *)malloc(totinter*sizeof(struct CompleteInteraction));
-    map = (int  *)malloc(totinter*sizeof(int)); //map interaction-id to variable-id (from 0)
-    revmap = (int  *)malloc(totinter*sizeof(int)); //map variable-id to interaction-id
-
-    int n=0;
-    for (i=0; i<G.numedges;i++)
-        for (j=0; j<G.edgearray[i]->numinter; j++) {
-            incinters[G.edgearray[i]->dest][numincinters[G.edgearray[i]->dest]++] = n;
-            outinters[G.edgearray[i]->src][numoutinters[G.edgearray[i]->src]++] = n;
-            inters[n].src = G.edgearray[i]->src;
-            if (G.edgearray[i]->src==0)
-                map[n] = -1;
-            else {
-                map[n] = Ncol;
-                revmap[Ncol] = n;
-                Ncol++;
-            }
-            
-            inters[n].dest = G.edgearray[i]->dest;
-            inters[n].timestamp = G.edgearray[i]->inter[j].timestamp;
-            inters[n++].quantity = G.edgearray[i]->inter[j].quantity;
-        }
-    
-    /*
-    //print interactions
-    for (i=0;i<totinter;i++) {
-        printf("%d %d %f %f\n",inters[i].src,inters[i].dest,inters[i].timestamp,inters[i].quantity);
-    }
-
-    //print map
-    for (i=0;i<totinter;i++) {
-        printf("%d %d\n",i, map[i]);
-    }
-    
-    printf("number of variables=%d\n",Ncol);
-
-    //print interactions per node
-    for (i=0;i<G.numnodes;i++) {
-        printf("node %d incoming interactions:\n",i);
-        for (j=0;j<numincinters[i];j++)
-            printf("%d %d %f %f\n",inters[incinters[i][j]].src,inters[incinters[i][j]].dest,inters[incinters[i][j]].timestamp,inters[incinters[i][j]].quantity);
-        printf("node %d outgoing interactions:\n",i);
-        for (j=0;j<numoutinters[i];j++)
-            printf("%d %d %f %f\n",inters[outinters[i][j]].src,inters[outinters[i][j]].dest,inters[outinters[i][j]].timestamp,inters[outinters[i][j]].quantity);
-
-    }
-    */
-    
-    /* We will build the model row by row */
-    lp = make_lp(0, Ncol);
-    
-    if(lp == NULL)
-      ret = 1; /* couldn't construct a new model... */
-
-    if(ret == 0) {
-      /* let us name our variables. Not required, but can be useful for debugging */
-        for (i=0;i<Ncol;i++) {
-        	char snum[10];
-        	sprintf(snum, "x%d", i+1);
-            set_col_name(lp, i+1, snum);
-        }
-      /* create space large enough for one row */
-      colno = (int *) malloc(Ncol * sizeof(*colno));
-      row = (REAL *) malloc(Ncol * sizeof(*row));
-      if((colno == NULL) || (row == NULL))
-        ret = 2;
-    }
-
-    if(ret == 0) {
-        set_add_rowmode(lp, TRUE);  /* makes building the model faster if it is done rows by row */
-            
-        for (i=0; i<totinter; i++) {
-            if (inters[i].src != 0) {
-                //printf("%d\n",i);
-                /* two constraints per interaction*/
-                
-                /* first constraint is upper bound based on flow on interaction*/
-                j = 0;
-                
-                for(l=0; l<map[i]; l++) {
-                    colno[j] = l+1; /* first column */
-                    row[j++] = 0; /* coefficient */
-                }
-
-                colno[j] = map[i]+1; /* second column */
-                row[j++] = 1; /* coefficient */
-                l++;
-
-                for(; l<Ncol; l++) {
-                    colno[j] = l+1; /* first column */
-                    row[j++] = 0; /* coefficient */
-                }
-                
-                /*
-                printf("basic constraint:\n");
-                if (j!=Ncol)
-                    printf("problem\n");
-                else
-                    for (int s=0; s<Ncol; s++)
-                        printf("colno:%d row:%f\n",colno[s],row[s]);
-                printf("less than:%f\n",inters[i].quantity);
-                */
-                
-                /* add the row to lpsolve */
-                if(!add_constraintex(lp, Ncol, row, colno, LE, inters[i].quantity))
-                  ret = 3;
-
-                //printf("ok\n");
-                /* second constraint is based on feasible flow transfer*/
-                //initialize all
-                for(j=0; j<Ncol; j++) {
-                    colno[j] = j+1;
-                    row[j] = 0;
-                }
-            
-                //set variable corresponding to interaction
-                colno[map[i]] = map[i]+1;
-                row[map[i]] = 1;
-
-                //consider other interactions
-                double fromsource=0;
-                for (int s=0; s<totinter; s++) {
-                    if (s==i) continue;
-                    if (inters[s].src==0 && inters[s].dest==inters[i].src && inters[s].timestamp<inters[i].timestamp)
-                        fromsource+=inters[s].quantity;
-                    else { // check incoming/outgoing interactions to/from src
-                        if (inters[s].src!=0 && inters[s].dest==inters[i].src && inters[s].timestamp<inters[i].timestamp) {
-                            colno[map[s]]=map[s]+1;
-                            row[map[s]] = -1;
-                        }
-                        else if (inters[s].src==inters[i].src && inters[s].timestamp<inters[i].timestamp) {
-                            colno[map[s]]=map[s]+1;
-                            row[map[s]] = 1;
-                        }
-                    }
-                }
-                
-                /*
-                printf("other constraint:\n");
-                for (int s=0; s<Ncol; s++)
-                        printf("colno:%d row:%f\n",colno[s],row[s]);
-                printf("less than:%f\n",fromsource);
-                */
-                
-                /* add the row to lpsolve */
-                if(!add_constraintex(lp, j, row, colno, LE, fromsource))
-                  ret = 3;
-
-            }
-        }
-    }
-    
- 
-    if(ret == 0) {
-		set_add_rowmode(lp, FALSE); /* rowmode should be turned off again when done building the model */
-
-		/* set the objective function */
-		
-		//initalization
-		for (i=0; i<Ncol; i++) {
-			colno[i] = i+1; 
-			row[i] = 0;
-		}
 
-		//now set variables corresponding to interactions that have as destination the sink node
-		for (i=0; i<totinter; i++)
-            if (inters[i].src != 0 && inters[i].dest == G.numnodes-1)
-            	row[map[i]]=1;
-            	
-        /*
-        printf("objective function for maximization:\n");
-		for (int i=0; i<Ncol; i++)
-				printf("colno:%d row:%f\n",colno[i],row[i]);
-		*/
-		
-		/* set the objective in lpsolve */
-		if(!set_obj_fnex(lp, Ncol, row, colno))
-		  ret = 4;
-  	}
-  
+    ret = buildFlowLP(G, LPMODEL_INTER, &m);
 
     if(ret == 0) {
-      /* set the object direction to maximize */
-      set_maxim(lp);
-
-      /* just out of curioucity, now show the model in lp format on screen */
-      /* this only works if this is a console application. If not, use write_lp and a filename */
-      //write_LP(lp, stdout);
-      /* write_lp(lp, "model.lp"); */
-
-      /* I only want to see important messages on screen while solving */
-      set_verbose(lp, IMPORTANT);
-  
       /* Now let lpsolve calculate a solution */
-      //t = clock();   
-      //printf("solving LP now\n"); 
-      ret = solve(lp);
-      //printf("ret=%d\n",ret); 
-      //t = clock() - t;
-      //time_taken = ((double)t)/CLOCKS_PER_SEC;
-      //printf("Total time of lpsolve: %f seconds\n", time_taken);
-      
+      ret = solve(m.lp);
       if(ret == OPTIMAL)
         ret = 0;
       else
         ret = 5;
     }
-        
-  
-    if(ret == 0) {
-       /* a solution is calculated, now lets get some results */
-
-       /* objective value */
-       //printf("Objective value: %f\n", get_objective(lp));
 
+    if(ret == 0) {
        /* variable values */
-       get_variables(lp, row);
-       
-       for(j = 0; j < Ncol; j++) {
-         //printf("%s: %f\n", get_col_name(lp, j + 1), row[j]);
-         if(inters[revmap[j]].dest == G.numnodes-1 && row[j]>0) {
-         	(*inter)[(*numinter)].timestamp =  inters[revmap[j]].timestamp;
+       row = (REAL *) malloc((m.Ncol+1) * sizeof(*row));
+       get_variables(m.lp, row);
+       for(j = 0; j < m.Ncol; j++) {
+         if(m.inters[m.revmap[j]].dest == G.numnodes-1 && row[j]>0) {
+         	(*inter)[(*numinter)].timestamp =  m.inters[m.revmap[j]].timestamp;
          	(*inter)[(*numinter)++].quantity =  row[j];
          }
        }
+       free(row);
 
-       //for(j = 0; j < Ncol; j++)
-       //  printf("%s: %f\n", get_col_name(lp, j + 1), row[j]);
-
-       /* we are done now */
-       
        // total flow is objective value + total incoming flow directly from source to sink
 		double directflow =0;
-		//now set variables corresponding to interactions that have as destination the sink node
-		for (i=0; i<totinter; i++)
-			if (inters[i].src == 0 && inters[i].dest == G.numnodes-1) {
-				(*inter)[(*numinter)].timestamp =  inters[i].timestamp;
-				(*inter)[(*numinter)++].quantity =  inters[i].quantity;
-				directflow+=inters[i].quantity;
+		for (i=0; i<m.totinter; i++)
+			if (m.inters[i].src == 0 && m.inters[i].dest == G.numnodes-1) {
+				(*inter)[(*numinter)].timestamp =  m.inters[i].timestamp;
+				(*inter)[(*numinter)++].quantity =  m.inters[i].quantity;
+				directflow+=m.inters[i].quantity;
 			}
 		qsort((*inter), *numinter, sizeof(struct Interaction), compInter);
-		flow = get_objective(lp)+directflow;
-		//printf("Total flow: %f, based on interactions:\n", get_objective(lp)+directflow);
-	    //for (i=0; i<*numinter; i++)
-    	//	printf("%f %f\n",(*inter)[i].timestamp, (*inter)[i].quantity);
+		flow = get_objective(m.lp)+directflow;
      }
-     
-     /* free allocated memory */
-     if(row != NULL)
-       free(row);
-     if(colno != NULL)
-       free(colno);
 
-     if(lp != NULL) {
-       /* clean up such that all used memory by lpsolve is freed */
-       delete_lp(lp);
-     }
-     
-     
-     for (i=0; i<G.numnodes;i++) {
-        free(incinters[i]);
-        free(outinters[i]);
-     }
-     free(numincinters);
-     free(incinters);
-     free(numoutinters);
-     free(outinters);
-	 free(inters);
-	 free(map);
-	 free(revmap);
-	 
+     freeFlowLP(&m);
      return(flow);
 }
 
@@ -1691,174 +1840,399 @@ int reachable(int dest, int src, int destnode, struct Edge** edgearray, int nume
 	return found;
 }
 
-//returns 1 if dest is reachable from src in edgearray
-//slow and suboptimal, but it works (normally we need data structures)
-//trying to make it faster by avoiding redundant recursions
-int reachable2(int dest, int src, int destnode, struct Edge** edgearray, int numedges, struct Edge** curedges, int len, int *examinednodes, int *numexaminednodes)
+// initializes an empty edge set
+void initEdgeSet(struct EdgeSet *es)
 {
-	int i,j;
-	int found = 0;
-	//if(dest==55) printf("here\n");
-	for (i=0; i<numedges; i++) {
-		if (edgearray[i]->src == src)
-		{
-			//if(dest==55) printf("here2\n");
-			if (edgearray[i]->dest == dest) // found
-				return 1;
-			if (edgearray[i]->dest != destnode) {
-				for(j=0; j<*numexaminednodes; j++)
-					if (edgearray[i]->dest==examinednodes[j])
-						break;
-				//if (dest==55) printf("here3:nextsrc=%d,dest=%d,j=%d,*numexaminednodes=%d\n",edgearray[i]->dest,dest,j,*numexaminednodes);
-				if (j==*numexaminednodes) //not examined before
-					found = reachable2(dest, edgearray[i]->dest, destnode, edgearray, numedges, curedges, len, examinednodes, numexaminednodes);
-				if (found) return 1;
-				//if (dest==55) printf("here4\n");
-				examinednodes[(*numexaminednodes)++] = edgearray[i]->dest; //mark as examined
-				//if (dest==55) printf("%d\n",edgearray[i]->dest);
-			}
-		}
+	es->numedges = 0;
+	es->maxedges = 1024;
+	es->edge = (struct Edge **)malloc(es->maxedges*sizeof(struct Edge *));
+	es->tablesize = 2*es->maxedges;
+	es->table = (struct Edge **)calloc(es->tablesize,sizeof(struct Edge *));
+}
+
+// slot of edge e in the hash table of es: either e itself or the empty slot where e belongs
+static inline int edgeSetSlot(struct EdgeSet *es, struct Edge *e)
+{
+	// edges are pool entries, so their addresses differ by multiples of sizeof(struct Edge)
+	unsigned long long h = ((unsigned long long)(size_t)e / sizeof(struct Edge)) * 0x9E3779B97F4A7C15ULL;
+	int slot = (int)(h >> 32) & (es->tablesize-1);
+	while (es->table[slot] != NULL && es->table[slot] != e)
+		slot = (slot+1) & (es->tablesize-1);
+	return slot;
+}
+
+// adds e to es unless it is already there; returns 1 if e was added, 0 otherwise
+int addToEdgeSet(struct EdgeSet *es, struct Edge *e)
+{
+	int slot = edgeSetSlot(es, e);
+	if (es->table[slot] == e)
+		return 0;
+	if (es->numedges == es->maxedges) { // grow list and rehash (table stays at most half full)
+		es->maxedges *= 2;
+		es->edge = (struct Edge **)realloc(es->edge,es->maxedges*sizeof(struct Edge *));
+		free(es->table);
+		es->tablesize = 2*es->maxedges;
+		es->table = (struct Edge **)calloc(es->tablesize,sizeof(struct Edge *));
+		for (int i=0; i<es->numedges; i++)
+			es->table[edgeSetSlot(es, es->edge[i])] = es->edge[i];
+		slot = edgeSetSlot(es, e);
 	}
-	//if(dest==55) printf("here-cur\n");
-	if (found) return 1;
-	// examine also current edges array
-	for (i=0; i<len-2; i++) {
-		if (curedges[i]->src == src)
-		{
-			if (curedges[i]->dest == dest) // found
-				return 1;
-			if (curedges[i]->dest != destnode) {
-				for(j=0; j<*numexaminednodes; j++)
-					if (curedges[i]->dest==examinednodes[j])
-						break;
-				if (j==*numexaminednodes) //not examined before
-					found = reachable2(dest, curedges[i]->dest, destnode, edgearray, numedges, curedges, len,  examinednodes, numexaminednodes);
-				if (found) return 1;
-				examinednodes[(*numexaminednodes)++] = edgearray[i]->dest; //mark as examined
-				//if (dest==55) printf("%d\n",edgearray[i]->dest);
+	es->table[slot] = e;
+	es->edge[es->numedges++] = e;
+	return 1;
+}
+
+// returns 1 if e is in es, 0 otherwise
+int inEdgeSet(struct EdgeSet *es, struct Edge *e)
+{
+	return es->table[edgeSetSlot(es, e)] == e;
+}
+
+// removes all edges from es; memory is kept for the next query
+void clearEdgeSet(struct EdgeSet *es)
+{
+	// undo the insertions in reverse order: every lookup then sees the table as it was when
+	// the edge was inserted, so its probe sequence ends at its own slot
+	for (int i=es->numedges-1; i>=0; i--)
+		es->table[edgeSetSlot(es, es->edge[i])] = NULL;
+	es->numedges = 0;
+}
+
+void freeEdgeSet(struct EdgeSet *es)
+{
+	free(es->edge);
+	free(es->table);
+}
+
+// allocates scratch space for path queries on a graph with numnodes nodes
+void initPathScratch(struct PathScratch *ps, int numnodes)
+{
+	ps->numnodes = numnodes;
+	ps->mark = (int *)calloc(numnodes,sizeof(int));
+	ps->epoch = 0;
+	ps->stack = (int *)malloc(numnodes*sizeof(int));
+	ps->ord = (int *)malloc(numnodes*sizeof(int));
+	ps->ordstamp = (int *)calloc(numnodes,sizeof(int));
+	ps->outhead = (int *)malloc(numnodes*sizeof(int));
+	ps->inhead = (int *)malloc(numnodes*sizeof(int));
+	ps->query = 0;
+	ps->numord = 0;
+	ps->maxrecs = 1024;
+	ps->recs = (struct OrderEdge *)malloc(ps->maxrecs*sizeof(struct OrderEdge));
+	ps->numrecs = 0;
+	ps->freerec = -1;
+	ps->maxdelta = 0;
+	ps->deltaF = NULL;
+	ps->deltaB = NULL;
+	ps->ordpool = NULL;
+	ps->maxlen = 0;
+	ps->curedges = NULL;
+	ps->node = NULL;
+	ps->nextedge = NULL;
+	ps->rec = NULL;
+	ps->arrival = NULL;
+	ps->dist = (int *)malloc(numnodes*sizeof(int));
+	ps->diststamp = (int *)calloc(numnodes,sizeof(int));
+}
+
+void freePathScratch(struct PathScratch *ps)
+{
+	free(ps->mark);
+	free(ps->stack);
+	free(ps->ord);
+	free(ps->ordstamp);
+	free(ps->outhead);
+	free(ps->inhead);
+	free(ps->recs);
+	free(ps->deltaF);
+	free(ps->deltaB);
+	free(ps->ordpool);
+	free(ps->curedges);
+	free(ps->node);
+	free(ps->nextedge);
+	free(ps->rec);
+	free(ps->arrival);
+	free(ps->dist);
+	free(ps->diststamp);
+}
+
+// returns a new epoch for the visited marks (marks of earlier epochs count as unvisited)
+static inline int newEpoch(struct PathScratch *ps)
+{
+	if (ps->epoch == INT_MAX) { // wrap around: clear marks once
+		memset(ps->mark,0,ps->numnodes*sizeof(int));
+		ps->epoch = 0;
+	}
+	return ++ps->epoch;
+}
+
+// gives node u a position in the topological order, after all nodes seen so far in the query
+static inline void touchNode(struct PathScratch *ps, int u)
+{
+	if (ps->ordstamp[u] != ps->query) {
+		ps->ordstamp[u] = ps->query;
+		ps->ord[u] = ps->numord++;
+		ps->outhead[u] = -1;
+		ps->inhead[u] = -1;
+	}
+}
+
+//compare two nodes by topological order; used by qsort call in function reorder
+static int compOrder(const void *a, const void *b) {
+	return ((struct OrderedNode *)a)->ord - ((struct OrderedNode *)b)->ord;
+}
+
+// Pearce-Kelly step for new edge x->y with ord[y] < ord[x]: moves the nodes that reach x
+// (with order above ord[y]) in front of the nodes reachable from y (found in deltaF by
+// the forward search), reusing their order positions
+static void reorder(struct PathScratch *ps, int x, int y, int epoch, int numF)
+{
+	int lb = ps->ord[y];
+	int numB = 0;
+	int top = 0;
+	int i,j,k;
+
+	// backward search from x; nodes reachable from y are marked already, and no node
+	// can be both (that would be a cycle)
+	ps->mark[x] = epoch;
+	ps->stack[top++] = x;
+	while (top > 0) {
+		int u = ps->stack[--top];
+		ps->deltaB[numB].node = u;
+		ps->deltaB[numB++].ord = ps->ord[u];
+		for (int r = ps->inhead[u]; r != -1; r = ps->recs[r].nextin) {
+			int w = ps->recs[r].src;
+			if (ps->ord[w] > lb && ps->mark[w] != epoch) {
+				ps->mark[w] = epoch;
+				ps->stack[top++] = w;
 			}
 		}
 	}
-	return found;
+	qsort(ps->deltaB, numB, sizeof(struct OrderedNode), compOrder);
+	qsort(ps->deltaF, numF, sizeof(struct OrderedNode), compOrder);
+
+	// pool of the affected order positions, sorted
+	for (i=0, j=0, k=0; i<numB || j<numF; k++)
+		if (j>=numF || (i<numB && ps->deltaB[i].ord < ps->deltaF[j].ord))
+			ps->ordpool[k] = ps->deltaB[i++].ord;
+		else
+			ps->ordpool[k] = ps->deltaF[j++].ord;
+	for (i=0, k=0; i<numB; i++)
+		ps->ord[ps->deltaB[i].node] = ps->ordpool[k++];
+	for (j=0; j<numF; j++)
+		ps->ord[ps->deltaF[j].node] = ps->ordpool[k++];
 }
 
-// used by findPaths2 function below to discover paths from a given source to a given sink
-// in order to construct a DAG
-// WARNING: certain edges are disqualified (if they are susceptible to close cycles)
-void expandpath_findpaths2(struct Graph G,  struct CPattern path, int i, int destnode, int len, int maxlen, struct Edge** curedges,  struct Edge** edgearray, int *numedges, int *totinter) 
+// checks whether edge x->y closes a cycle with the edges kept in the order structure
+// if not, the edge is added (the order is updated if needed) and its record is returned;
+// returns -1 if the edge closes a cycle
+static int orderEdge(struct PathScratch *ps, int x, int y)
 {
-	int j,k;
-	int endlabel;
-	
-	int pathfound = 0; // flags that valid path is found
-	int loops = 0; // flags that a loop is found
-	int chain = 0; // flags a loop-less chain, e.g. x->y->z->w
-	int valid = 1; // used to detect an invalid path, e.g. x->y->z->y
-	int *examinednodes = (int *)malloc(MAXEDGES*sizeof(int));
-	int numexaminednodes;  // used in reachability test for loops
-	
-	if (len>1) { // only paths of at least two vertices are interesting
-		endlabel=path.labels[len-1];
-		if (G.node[destnode].label == endlabel) {// found valid path
-			//printf("path found!\n");
-			//printpath(path,len);
-			pathfound = 1; // path found!
-			if  ((*numedges)+len <MAXEDGES) { //ignore paths exceeding total edges limit
-				for (k=0;k<len-1;k++) { //for each edge in curedges (current path)
-					// check if edge is already in edgearray (suboptimal way)
-					for (j=0;j<*numedges;j++)
-						// avoid same edge again or loop edge (unless it is last edge on path)
-						if (edgearray[j]==curedges[k]) 
-		//				if (edgearray[j]==curedges[k] ||(k<len-2 && curedges[k]->src==edgearray[j]->dest && curedges[k]->dest==edgearray[j]->src && path.labels[0]!=curedges[k]->src)) //this is better: works for DAGs where src=dest
-		//				if (edgearray[j]==curedges[k] ||(k<len-2 && curedges[k]->src==edgearray[j]->dest && curedges[k]->dest==edgearray[j]->src))
-						//					if (edgearray[j]==curedges[k]) 
-							break;
-					if (j==*numedges) {// not broken
-						//printf("new edge: %d->%d\n",curedges[k]->src,curedges[k]->dest);
-						edgearray[(*numedges)++]=curedges[k];
-						(*totinter)+=curedges[k]->numinter;
-						//printf("%d: added %d->%d\n",*numedges,curedges[k]->src,curedges[k]->dest);
-					}
+	touchNode(ps, x);
+	touchNode(ps, y);
+	if (ps->ord[x] > ps->ord[y]) {
+		// forward search from y among the nodes ordered before x; reaching x means a cycle
+		int ub = ps->ord[x];
+		int epoch = newEpoch(ps);
+		int top = 0;
+		int numF = 0;
+		if (ps->numord > ps->maxdelta) {
+			ps->maxdelta = ps->numnodes < 2*ps->numord ? ps->numnodes : 2*ps->numord;
+			ps->deltaF = (struct OrderedNode *)realloc(ps->deltaF,ps->maxdelta*sizeof(struct OrderedNode));
+			ps->deltaB = (struct OrderedNode *)realloc(ps->deltaB,ps->maxdelta*sizeof(struct OrderedNode));
+			ps->ordpool = (int *)realloc(ps->ordpool,2*ps->maxdelta*sizeof(int));
+		}
+		ps->mark[y] = epoch;
+		ps->stack[top++] = y;
+		while (top > 0) {
+			int u = ps->stack[--top];
+			ps->deltaF[numF].node = u;
+			ps->deltaF[numF++].ord = ps->ord[u];
+			for (int r = ps->outhead[u]; r != -1; r = ps->recs[r].nextout) {
+				int w = ps->recs[r].dest;
+				if (w == x) // found
+					return -1;
+				if (ps->ord[w] < ub && ps->mark[w] != epoch) {
+					ps->mark[w] = epoch;
+					ps->stack[top++] = w;
 				}
 			}
-			else {
-				free(examinednodes);
-				return;
-			}
-		}
-		else if (path.labels[0] == endlabel) {// loop condition
-			loops = 1; // loop found!
 		}
-		
-		else if (len>2)
-		{
-			// check if current edge closes cycle (together with current paths)
-			// in this case path is rejected: we set loops=1
-			
-			// if curedges[len-2]->src is reachable from curedges[len-2]->dest in edgearray, then current path should be rejected
-			
-			//if (curedges[len-2]->src== 2 && curedges[len-2]->dest==1) {
-			//	printf("%d edges:\n",*numedges);
-			//	for(j=0; j<*numedges; j++)
-			//		printf("%d->%d\n",edgearray[j]->src,edgearray[j]->dest);
-			//	printf("curedges:\n");
-			//	for(j=0; j<len-1; j++)
-			//		printf("%d->%d\n",curedges[j]->src,curedges[j]->dest);
-			//}
-			//printf("examining: %d->%d (len=%d, numedges=%d): \n",curedges[len-2]->src,curedges[len-2]->dest,len,*numedges);
-			numexaminednodes = 0;
-			if (reachable2(curedges[len-2]->src, curedges[len-2]->dest, destnode, edgearray, *numedges, curedges, len, examinednodes, &numexaminednodes))
-				loops = 1; //signals invalid path	
-				
-			//printf("loops=%d\n",loops);			
+		reorder(ps, x, y, epoch, numF);
+	}
+
+	// take a record from the free list (or the end of the pool) and link it into both lists
+	int r = ps->freerec;
+	if (r != -1)
+		ps->freerec = ps->recs[r].nextout;
+	else {
+		if (ps->numrecs == ps->maxrecs) {
+			ps->maxrecs *= 2;
+			ps->recs = (struct OrderEdge *)realloc(ps->recs,ps->maxrecs*sizeof(struct OrderEdge));
 		}
+		r = ps->numrecs++;
 	}
-					
-	if (len == 1 || (len<maxlen && !pathfound && !loops)){ // expand single vertices or chain paths with less than maxlen nodes
-		for(j=0; j<G.node[i].numout; j++) {
-			//printf("going to %d\n",G.node[i].edge[j].dest);
-			path.labels[len] = G.node[i].edge[j].dest;
-			if (path.labels[len-1]==path.labels[len]) continue; //avoid selfloop expansion (a->a)
-			curedges[len-1] = &G.node[i].edge[j];
-			expandpath_findpaths2(G,path,G.node[i].edge[j].dest,destnode,len+1,maxlen, curedges, edgearray, numedges, totinter);
+	struct OrderEdge *oe = &ps->recs[r];
+	oe->src = x;
+	oe->dest = y;
+	oe->prevout = -1;
+	oe->nextout = ps->outhead[x];
+	if (oe->nextout != -1)
+		ps->recs[oe->nextout].prevout = r;
+	ps->outhead[x] = r;
+	oe->previn = -1;
+	oe->nextin = ps->inhead[y];
+	if (oe->nextin != -1)
+		ps->recs[oe->nextin].previn = r;
+	ps->inhead[y] = r;
+	return r;
+}
+
+// removes an edge record from the order structure; the order stays valid
+static void unorderEdge(struct PathScratch *ps, int r)
+{
+	struct OrderEdge *oe = &ps->recs[r];
+	if (oe->prevout != -1)
+		ps->recs[oe->prevout].nextout = oe->nextout;
+	else
+		ps->outhead[oe->src] = oe->nextout;
+	if (oe->nextout != -1)
+		ps->recs[oe->nextout].prevout = oe->prevout;
+	if (oe->previn != -1)
+		ps->recs[oe->previn].nextin = oe->nextin;
+	else
+		ps->inhead[oe->dest] = oe->nextin;
+	if (oe->nextin != -1)
+		ps->recs[oe->nextin].previn = oe->previn;
+	oe->nextout = ps->freerec;
+	ps->freerec = r;
+}
+
+// labels every node that reaches destnode over at most maxhops edges with its hop distance
+// (breadth-first search over the incoming-edge index of G, starting at destnode)
+// paths are not continued beyond sourcenode (unless it is destnode), so neither is the search
+static void labelDistances(struct Graph *G, int sourcenode, int destnode, int maxhops, struct PathScratch *ps)
+{
+	int *queue = ps->stack; // not used by the order structure before the path search starts
+	int head = 0;
+	int tail = 0;
+
+	ps->dist[destnode] = 0;
+	ps->diststamp[destnode] = ps->query;
+	queue[tail++] = destnode;
+	while (head < tail) {
+		int v = queue[head++];
+		if (ps->dist[v] >= maxhops || (v == sourcenode && v != destnode))
+			continue;
+		for (long long k=G->incoff[v]; k<G->incoff[v+1]; k++) {
+			int u = G->incedges[k]->src;
+			if (ps->diststamp[u] != ps->query) {
+				ps->dist[u] = ps->dist[v]+1;
+				ps->diststamp[u] = ps->query;
+				queue[tail++] = u;
+			}
 		}
 	}
-	free(examinednodes);
 }
 
 // finds all paths from sourcenode to destnode up to a maximum length 
 // paths should not contain the same node twice (except if sourcenode=destnode) 
 // (this constraint is not yet fully implemented)
-// adds all distinct edges in these paths to edgearray
+// adds all distinct edges in these paths to edge set es (emptied first), in order of discovery
 // does not add or continue paths which close cycles based on current set of edges
-int findPaths2(struct Graph G, int sourcenode, int destnode, int maxlen, struct Edge** edgearray, int *numedges)
+// the paths are enumerated depth-first with an explicit stack; ps holds all scratch space,
+// so a query allocates memory only when es or ps have to grow
+// cycles are detected with a dynamic topological order (Pearce-Kelly) of the edges in es and
+// on the current path; edges into destnode are left out, as destnode becomes the DAG's sink
+// branches that cannot reach destnode within maxlen nodes are cut using the hop distances of
+// labelDistances, so only the backward neighbourhood of destnode is enumerated
+// paths are also cut where they become infeasible in time: the earliest time flow can arrive at
+// a path node is bounded by the first interaction of each edge so far; an edge whose last
+// interaction is earlier than that cannot pass on any flow (decided on the edge summaries of G)
+int findPaths2(struct Graph G, int sourcenode, int destnode, int maxlen, struct EdgeSet *es, struct PathScratch *ps)
 {
-	int i,j,k;
-	int totinter = 0; //total number of interactions in edges of resulting edgearray
-	
-	struct Edge **curedges = (struct Edge **)malloc(maxlen*sizeof(struct Edge *)); //holds edges in current path 
-	
-	(*numedges) = 0; //number of edges in valid paths
-	
-	//int *visited;
-	int len=0;
-	struct CPattern path; //holds instance of path
-	
-	path.labels = (int *)malloc(maxlen*sizeof(int));
-	path.numnodes = 1;
-	path.labels[0]=G.node[sourcenode].label;
-	expandpath_findpaths2(G,path,sourcenode,destnode,len+1,maxlen, curedges, edgearray, numedges, &totinter); 
-	
-	//for(i=0;i<*numedges;i++)
-	//	printf("%d->%d\n",edgearray[i]->src,edgearray[i]->dest);
-	
-	free(curedges);
-	free(path.labels);
-	
+	int totinter = 0; //total number of interactions in edges of resulting edge set
+	int len; // number of nodes in current path
+	int k;
+
+	clearEdgeSet(es); //edges in valid paths
+	if (ps->query == INT_MAX) { // wrap around: clear order and distance stamps once
+		memset(ps->ordstamp,0,ps->numnodes*sizeof(int));
+		memset(ps->diststamp,0,ps->numnodes*sizeof(int));
+		ps->query = 0;
+	}
+	ps->query++;
+	ps->numord = 0;
+	ps->numrecs = 0;
+	ps->freerec = -1;
+	if (maxlen+1 > ps->maxlen) {
+		ps->maxlen = maxlen+1;
+		ps->curedges = (struct Edge **)realloc(ps->curedges,ps->maxlen*sizeof(struct Edge *)); //holds edges in current path
+		ps->node = (int *)realloc(ps->node,ps->maxlen*sizeof(int)); //holds nodes in current path
+		ps->nextedge = (int *)realloc(ps->nextedge,ps->maxlen*sizeof(int)); //next out-edge to expand per path node
+		ps->rec = (int *)realloc(ps->rec,ps->maxlen*sizeof(int)); //order record of each path edge
+		ps->arrival = (double *)realloc(ps->arrival,ps->maxlen*sizeof(double)); //earliest arrival time per path node
+	}
+	struct Edge **curedges = ps->curedges;
+	// a node at position len of a path (len nodes) can be continued only if its distance is at most maxlen-len
+	labelDistances(&G, sourcenode, destnode, maxlen-2, ps);
+
+	// path of len nodes is ps->node[0..len-1], its edges are curedges[0..len-2]
+	// rec[k] is the order record of curedges[k] if it is only on the path (not in es), else -1
+	len = 1;
+	ps->node[0] = sourcenode;
+	ps->nextedge[0] = 0; // expand single vertex
+	ps->arrival[0] = -MAXTIME; // source can send at any time
+	while (len > 0) {
+		int i = ps->node[len-1];
+		if (ps->nextedge[len-1] >= G.node[i].numout) { // node done: backtrack
+			if (len > 1 && ps->rec[len-2] != -1)
+				unorderEdge(ps, ps->rec[len-2]);
+			len--;
+			continue;
+		}
+		struct Edge *e = &G.node[i].edge[ps->nextedge[len-1]++];
+		if (e->dest == i) continue; //avoid selfloop expansion (a->a)
+		if (ps->diststamp[e->dest] != ps->query || len+1+ps->dist[e->dest] > maxlen)
+			continue; //destnode out of reach: no valid path through e
+		struct EdgeSummary *sum = &G.summary[e-G.edges];
+		if (sum->numinter == 0 || sum->maxtime < ps->arrival[len-1])
+			continue; //no flow can pass through e on this path
+		curedges[len-1] = e;
+		ps->rec[len-1] = -1;
+		ps->arrival[len] = (sum->mintime > ps->arrival[len-1]) ? sum->mintime : ps->arrival[len-1];
+		ps->node[len++] = e->dest;
+
+		int pathfound = 0; // flags that valid path is found
+		int loops = 0; // flags that a loop is found
+		if (e->dest == destnode) {// found valid path
+			pathfound = 1;
+			for (k=0;k<len-1;k++) //for each edge in curedges (current path)
+				if (addToEdgeSet(es, curedges[k])) { // avoid same edge again
+					totinter += curedges[k]->numinter;
+					ps->rec[k] = -1; // stays in the order structure
+				}
+		}
+		else if (e->dest == sourcenode) {// loop condition
+			loops = 1; // loop found!
+		}
+		else if (len<maxlen && !inEdgeSet(es, e)) { // edges of es are in the order structure already
+			// check if current edge closes cycle (together with current paths)
+			// edges leaving the source (len==2) cannot, as edges into the source are never kept
+			// a path of maxlen nodes is not expanded anyway, so its last edge needs no check
+			int r = orderEdge(ps, e->src, e->dest);
+			if (r == -1 && len > 2)
+				loops = 1; //signals invalid path
+			else if (r >= 0)
+				ps->rec[len-2] = r;
+		}
+		// expand chain paths with less than maxlen nodes
+		ps->nextedge[len-1] = (len<maxlen && !pathfound && !loops) ? 0 : G.node[e->dest].numout;
+	}
+
 	return totinter;
 }
 
-
 /*
 // used by findPaths2 function below to discover paths from a given source to a given sink
 // in order to construct a DAG
@@ -1987,232 +2361,416 @@ int findPaths3(struct Graph G, int sourcenode, int destnode, int maxlen, struct
 // returns incoming interactions to sink, which accumulate to total flow
 double simplifyChain(struct Edge **edgearray, int numedges, struct Interaction **inter, int *numinter)
 {
-    int i,j,k;
-    double *buffer;
-    int *ptr;
-    int minedge;
-    double flow;
-    
-    //initialize returned data
-    *numinter = 0; 
-    //int sink = edgearray[numedges-1]->dest; //id of sink
-    *inter = (struct Interaction *)malloc(edgearray[numedges-1]->numinter*sizeof(struct Interaction));
-    
-    buffer = (double *)malloc((numedges+1)*sizeof(double));
-    for(i=1;i<numedges+1;i++) {
-        buffer[i]=0.0;
-    }
-    buffer[0]=MAXFLOW; // a very big number
+	int chainstart[2] = {0, numedges};
+	int interstart[2];
+	double flow;
 
-    ptr = (int *)malloc((numedges)*sizeof(int));
-    for(i=0;i<numedges;i++) {
-        ptr[i]=0;
-    }
+	simplifyChains(edgearray, chainstart, 1, &flow, inter, interstart);
+	*numinter = interstart[1];
+	return flow;
+}
 
-    //merge interactions on edges and compute flow
-    while ((minedge = find_minedge(edgearray, numedges, ptr)) != -1) {
-        //printf("minedge:%d,src:%d,dest:%d,ptr:%d,time:%f,qty:%f\n", minedge, G.edgearray[minedge]->src,  G.edgearray[minedge]->dest, ptr[minedge], G.edgearray[minedge]->inter[ptr[minedge]].timestamp, G.edgearray[minedge]->inter[ptr[minedge]].quantity);
-        flow = (buffer[minedge] < edgearray[minedge]->inter[ptr[minedge]].quantity) ? buffer[minedge] : edgearray[minedge]->inter[ptr[minedge]].quantity ;
-        //printf("flow=%f\n",flow);
-        buffer[minedge] -= flow;
-        buffer[minedge+1] += flow;
-        if ((minedge==numedges-1) && flow>0) {
-        	(*inter)[(*numinter)].timestamp =  edgearray[minedge]->inter[ptr[minedge]].timestamp;
-        	(*inter)[(*numinter)++].quantity =  flow;
-        }
-        ptr[minedge]++;
-    }
-    
-/*
-    for (i=0; i<G.numnodes; i++) {
-        //printf("flow at node %d is %f\n",G.node[i].label, buffer[i]);
-        printf("flow at node %d is %f\n",i, buffer[i]);
-    }*/
-    flow = buffer[numedges];
-    //printf("flow at sink node %d is %f, based on interactions:\n",G.numnodes-1, buffer[G.numnodes-1]);
-    //for (i=0; i<*numinter; i++)
-    //	printf("%f %f\n",(*inter)[i].timestamp, (*inter)[i].quantity);
+// greedy flow through edge e of a chain, given the flow arriving at the source node of e as
+// interactions in[0..numin-1] (sorted by time); as in the LP, flow arriving at time t can only leave
+// at a later time
+// writes the interactions of e that carry flow to out (room for e->numinter) and returns their number
+static int chainEdgeFlow(const struct Interaction *in, int numin, const struct Edge *e, struct Interaction *out)
+{
+	double buffer = 0.0;
+	int i = 0;
+	int n = 0;
+
+	for (int j=0; j<e->numinter; j++) {
+		for (; i<numin && in[i].timestamp < e->inter[j].timestamp; i++)
+			buffer += in[i].quantity;
+		double flow = (buffer < e->inter[j].quantity) ? buffer : e->inter[j].quantity;
+		buffer -= flow;
+		if (flow>0) {
+			out[n].timestamp = e->inter[j].timestamp;
+			out[n++].quantity = flow;
+		}
+	}
+	return n;
+}
 
-	//printf("inter pointer: %p\n",(*inter));
-	free(buffer);
-	free(ptr);
-	
-    return flow;
+// same as simplifyChain for numchains chains: chain c consists of edges edgearray[chainstart[c]..chainstart[c+1]-1]
+// the incoming interactions to the sink of chain c are (*inter)[interstart[c]..interstart[c+1]-1]
+// (one malloc'd array for all chains) and its flow is flow[c]; interstart has numchains+1 elements
+// each chain is computed edge after edge: the interactions of an edge that carry flow are merged with
+// the interactions of the next edge, so the cost is linear in the number of interactions of the chain
+void simplifyChains(struct Edge **edgearray, int *chainstart, int numchains, double *flow, struct Interaction **inter, int *interstart)
+{
+	int c,k;
+	int maxinter = 0; // size of scratch arrays
+	int totinter = 0; // size of returned array
+	struct Interaction source = {-MAXTIME, MAXFLOW}; // the source node of a chain has all flow from the start
+
+	for (c=0; c<numchains; c++) {
+		for (k=chainstart[c]; k<chainstart[c+1]; k++)
+			if (edgearray[k]->numinter > maxinter)
+				maxinter = edgearray[k]->numinter;
+		totinter += edgearray[chainstart[c+1]-1]->numinter;
+	}
+	*inter = (struct Interaction *)malloc((totinter+1)*sizeof(struct Interaction));
+	struct Interaction *cur = (struct Interaction *)malloc((maxinter+1)*sizeof(struct Interaction));
+	struct Interaction *next = (struct Interaction *)malloc((maxinter+1)*sizeof(struct Interaction));
+
+	interstart[0] = 0;
+	for (c=0; c<numchains; c++) {
+		const struct Interaction *in = &source;
+		int numin = 1;
+		for (k=chainstart[c]; k<chainstart[c+1]-1; k++) {
+			numin = chainEdgeFlow(in, numin, edgearray[k], next);
+			struct Interaction *swap = cur; // flow out of this edge arrives at the next one
+			cur = next;
+			next = swap;
+			in = cur;
+		}
+		// last edge: interactions into the sink of the chain
+		int n = chainEdgeFlow(in, numin, edgearray[chainstart[c+1]-1], *inter+interstart[c]);
+		interstart[c+1] = interstart[c]+n;
+		flow[c] = 0.0;
+		for (k=interstart[c]; k<interstart[c+1]; k++)
+			flow[c] += (*inter)[k].quantity;
+	}
+	free(cur);
+	free(next);
 }
 
-// computes flow in DAG G by first finding all reducible chains from the source node
-// after reduction the resulting DAG is solved using LP 
-double compFlow(struct DAG G, int writeDAG)
+// merges interactions inter[0..numinter-1] into the interactions of DAG edge e
+// both lists are sorted by time; they are merged from the back, in place (equal timestamps: e's first)
+static void mergeInteractions(struct DAG *G, struct Edge *e, const struct Interaction *inter, int numinter)
 {
-	int i,k,l;
-	int changed=1; //marks whether at one pass of nodes, there are changes due to chains found
-	int numpasses = 0; //marks number of passes over all nodes
-	int *deletednodes = (int *)calloc(G.numnodes,sizeof(int)); //marks "deleted" nodes
-	int numdelnodes = 0;
-	struct Interaction *inter=NULL;
-	int numinter;
-	int prevdest;
-	double flow;
-	
-	while (changed)
+	int l;
+
+	ownInteractions(G, e, numinter+e->numinter);
+	int pos = e->numinter+numinter; // next free position, from the back
+	int old = e->numinter-1;
+	for (l=numinter-1; l>=0; l--) {
+		while (old>=0 && e->inter[old].timestamp > inter[l].timestamp)
+			e->inter[--pos] = e->inter[old--];
+		e->inter[--pos] = inter[l];
+	}
+	e->numinter += numinter;
+}
+
+// removes edge id from the incoming edges of node v (the last incoming edge takes its position)
+// returns 0, -1 if id is not an incoming edge of v
+static int removeIncoming(struct DAG *G, int v, int id)
+{
+	int l;
+
+	for (l=0; l<G->node[v].numinc; l++)
+		if (G->node[v].incedges[l]==id)
+			break;
+	if (l==G->node[v].numinc) {
+		printf("ERROR: edge %d not found in incoming edges of node %d\n",id,v);
+		return -1;
+	}
+	G->node[v].incedges[l]=G->node[v].incedges[--G->node[v].numinc];
+	return 0;
+}
+
+// scratch space of reduceDAG; the chain arrays hold the chains found in one pass over the source's edges
+struct ReduceScratch {
+	struct Edge **chainedges; // chain c is chainedges[chainstart[c]..chainstart[c+1]-1]
+	int *chainstart;
+	int *chainfirst; // id of first edge of chain from source (of last edge into sink, see reduceSinkChains)
+	int *chainlast; // last deleted node of chain
+	int *interstart; // interactions of chain c into its last node (see simplifyChains)
+	double *chainflow;
+	int *outpos; // position of edge id in outgoing edges of source
+	int *seenby; // seenby[v]==u if an edge u->v was seen while merging the edges of u
+	int *seenedge; // id of that edge
+};
+
+// series reduction at the source: every chain source->x1->...->xk->v (x1..xk have one incoming and
+// one outgoing edge) is replaced by an edge source->v carrying the greedy flow of the chain, which is
+// exact because the source has all flow from the start; if source->v exists, the chain is merged into it
+// the chains of one pass are simplified together; returns the number of chains replaced
+static int reduceSourceChains(struct DAG *G, int *deletednodes, struct ReduceScratch *rs)
+{
+	int i,k,c;
+	int prevdest = 0;
+	int numchains = 0;
+	struct Interaction *inter;
+
+	// collect the chains that start at outgoing edges of the source node
+	rs->chainstart[0] = 0;
+	for (i=0; i<G->node[0].numout; i++) //for each outgoing edge of source node
 	{
-		changed = 0; //2nd pass may not be necessary 
-		numpasses +=1;
-		//printf("PASS %d\n",numpasses);
-		for (i=0; i<G.node[0].numout; i++) //for each outgoing edge of source node
+		int dest = G->edgearray[G->node[0].outedges[i]]->dest;
+		rs->outpos[G->node[0].outedges[i]] = i;
+		if (!deletednodes[dest] && G->node[dest].numout==1 && G->node[dest].numinc==1) //dest is a chain node
 		{
-			int dest = G.edgearray[G.node[0].outedges[i]]->dest;
-			if (!deletednodes[dest] && G.node[dest].numout==1 && G.node[dest].numinc==1) //dest is a chain node
+			int numedges = rs->chainstart[numchains];
+			rs->chainedges[numedges++]=G->edgearray[G->node[0].outedges[i]];
+			while (G->node[dest].numout==1 && G->node[dest].numinc==1)
 			{
-				changed = 1; // we are going to have changes
-					
-				// this array keeps track of the edges in the chain
-				struct Edge **edgearray = (struct Edge **)malloc(G.numnodes*sizeof(struct Edge *));
-				// initially current edge: i->dest
-				edgearray[0]=G.edgearray[G.node[0].outedges[i]];
-				int numedges=1;
+				prevdest = dest;
+				deletednodes[prevdest] = 1; //this node is going to be "deleted"
+				dest = G->edgearray[G->node[prevdest].outedges[0]]->dest;
+				rs->chainedges[numedges++]=G->edgearray[G->node[prevdest].outedges[0]];
+			}
+			rs->chainfirst[numchains] = G->node[0].outedges[i];
+			rs->chainlast[numchains++] = prevdest;
+			rs->chainstart[numchains] = numedges;
+		}
+	}
+	if (numchains==0)
+		return 0;
 
-				while (G.node[dest].numout==1 && G.node[dest].numinc==1)
-				{
-					prevdest = dest;
-					deletednodes[prevdest] = 1; //this node is going to be "deleted"
-					numdelnodes++;
-					dest = G.edgearray[G.node[prevdest].outedges[0]]->dest;
-					edgearray[numedges++]=G.edgearray[G.node[prevdest].outedges[0]];
-				}
-				/*
-				printf("start=%d, dest=%d, numedges=%d\n",0,dest,numedges);
-				for(k=0;k<numedges;k++)
-					printf("%d->%d\n", edgearray[k]->src,edgearray[k]->dest);
-				*/
-				
-				//chain simplification; run greedy
-				numinter=0;
-				double flow = simplifyChain(edgearray, numedges, &inter, &numinter);
-				
-				/*
-				printf("Interactions:\n");
-				for(k=0;k<numinter;k++)
-					printf("%f %f\n", inter[k].timestamp,inter[k].quantity);
-				printf("flow=%f\n",flow);*/
-				
-				//check if edge 0->dest exists
-				for (k=0; k<G.node[0].numout; k++)
-					if (G.edgearray[G.node[0].outedges[k]]->dest == dest)
-						break; // edge already exists
-				if (k==G.node[0].numout)
-				{
-					// edge does not exist
-					// replace previous edge
-
-					//printf("Edge %d->%d does not exist, replacing dest of edge %d\n",0,dest,G.node[0].outedges[i]);
-
-					G.edgearray[G.node[0].outedges[i]]->dest = dest;
-					G.edgearray[G.node[0].outedges[i]]->numinter = numinter;
-					if (G.edgearray[G.node[0].outedges[i]]->inter != NULL)
-						free(G.edgearray[G.node[0].outedges[i]]->inter);
-					G.edgearray[G.node[0].outedges[i]]->inter = inter;
-					inter = NULL;
-					// new edge must go first (swapping)
-					// old edge must be deleted (swap with last one?)
-					// update numout
-				
-					// find and replace previous incoming edge to dest with new edge
-					for(l=0; l<G.node[dest].numinc; l++)
-						if (G.edgearray[G.node[dest].incedges[l]]->src==prevdest)
-							break;
-					if (l==G.node[dest].numinc) //not found
-						printf("ERROR: prevdest %d not found in incoming edges of dest %d\n",prevdest,dest);
-					else
-						//G.edgearray[G.node[dest].incedges[l]]->src=i;	
-						G.node[dest].incedges[l]=G.node[0].outedges[i];	
-					
-					/*
-					printf("Printing Incoming Edges of node %d\n",dest);
-					for(int w=0; w<G.node[dest].numinc; w++)
-						printf("incoming %d->%d\n",G.edgearray[G.node[dest].incedges[w]]->src,G.edgearray[G.node[dest].incedges[w]]->dest);
-								*/
-				}
-				else 
-				{
-					// edge exists => merge interactions in existing edge
-					
-					/*
-					printf("Edge %d->%d exists with order %d\n",0,dest,k);
-					printf("Merging with interactions:\n");
-					for(l=0;l<G.edgearray[G.node[0].outedges[k]]->numinter;l++)
-						printf("%f %f\n", G.edgearray[G.node[0].outedges[k]]->inter[l].timestamp,G.edgearray[G.node[0].outedges[k]]->inter[l].quantity);
-					printf("new total no of interactions=%d\n",numinter+G.edgearray[G.node[0].outedges[k]]->numinter);
-					*/
-					
-					G.edgearray[G.node[0].outedges[k]]->inter = (struct Interaction *)realloc(G.edgearray[G.node[0].outedges[k]]->inter, (numinter+G.edgearray[G.node[0].outedges[k]]->numinter)*sizeof(struct Interaction));
-					for(l=0; l<numinter; l++)
-						G.edgearray[G.node[0].outedges[k]]->inter[G.edgearray[G.node[0].outedges[k]]->numinter++]=inter[l];
-					
-					/*
-					printf("After merging before sorting:\n");
-					for(l=0;l<G.edgearray[G.node[0].outedges[k]]->numinter;l++)
-						printf("%f %f\n", G.edgearray[G.node[0].outedges[k]]->inter[l].timestamp,G.edgearray[G.node[0].outedges[k]]->inter[l].quantity);
-					*/
-					
-					qsort(G.edgearray[G.node[0].outedges[k]]->inter, G.edgearray[G.node[0].outedges[k]]->numinter, sizeof(struct Interaction), compInter);
-				
-					/*
-					printf("After merging and sorting:\n");
-					for(l=0;l<G.edgearray[G.node[0].outedges[k]]->numinter;l++)
-						printf("%f %f\n", G.edgearray[G.node[0].outedges[k]]->inter[l].timestamp,G.edgearray[G.node[0].outedges[k]]->inter[l].quantity);
-					*/
-						
-					// Old edges must be deleted
-					// 1) delete outgoing edge G.node[i].outedges[j]
-					// update G.node[i].numout
-					
-					G.node[0].outedges[i]=G.node[0].outedges[G.node[0].numout-1];
-					G.node[0].numout--;
-					i--;
-					
-					
-					// 2) delete incoming edge prevdest->dest
-					// update G.node[dest].numinc
-					for(l=0; l<G.node[dest].numinc; l++)
-						if (G.edgearray[G.node[dest].incedges[l]]->src==prevdest)
-							break;
-					if (l==G.node[dest].numinc) {//not found
-						printf("ERROR: prevdest %d not found in incoming edges of dest %d\n",prevdest,dest);
-					}
-					else {
-						//"transfer" last incoming edge to current position
-						G.node[dest].incedges[l]=G.node[dest].incedges[G.node[dest].numinc-1];
-						G.node[dest].numinc--;
-					}
-					
-					/*
-					printf("Printing Incoming Edges of node %d\n",dest);
-					for(int w=0; w<G.node[dest].numinc; w++)
-						printf("incoming %d->%d\n",G.edgearray[G.node[dest].incedges[w]]->src,G.edgearray[G.node[dest].incedges[w]]->dest);
-					*/
-				}
-			
-				free(edgearray);
-				if (inter!=NULL) {
-					free(inter);
-					inter = NULL;
-				}
+	//chain simplification; run greedy
+	simplifyChains(rs->chainedges, rs->chainstart, numchains, rs->chainflow, &inter, rs->interstart);
+
+	// replace each chain by an edge from the source to its last node
+	for (c=0; c<numchains; c++)
+	{
+		i = rs->outpos[rs->chainfirst[c]];
+		prevdest = rs->chainlast[c];
+		int dest = rs->chainedges[rs->chainstart[c+1]-1]->dest;
+		int lastid = G->node[prevdest].outedges[0]; // edge prevdest->dest
+		struct Interaction *chaininter = inter+rs->interstart[c];
+		int numinter = rs->interstart[c+1]-rs->interstart[c];
+
+		//check if edge 0->dest exists
+		for (k=0; k<G->node[0].numout; k++)
+			if (G->edgearray[G->node[0].outedges[k]]->dest == dest)
+				break; // edge already exists
+		if (k==G->node[0].numout)
+		{
+			// edge does not exist: first edge of chain becomes 0->dest
+			struct Edge *e = G->edgearray[G->node[0].outedges[i]];
+			e->dest = dest;
+			dropInteractions(e);
+			e->numinter = numinter;
+			e->inter = chaininter;
+			ownInteractions(G, e, numinter); // copied out of the array of all chains
+			// it replaces the incoming edge prevdest->dest of dest
+			for (k=0; k<G->node[dest].numinc; k++)
+				if (G->node[dest].incedges[k]==lastid)
+					G->node[dest].incedges[k]=G->node[0].outedges[i];
+		}
+		else 
+		{
+			// edge exists => merge interactions in existing edge
+			mergeInteractions(G, G->edgearray[G->node[0].outedges[k]], chaininter, numinter);
+			// old edges are deleted: first edge of chain from the source, prevdest->dest from dest
+			G->node[0].outedges[i]=G->node[0].outedges[G->node[0].numout-1];
+			rs->outpos[G->node[0].outedges[i]] = i;
+			G->node[0].numout--;
+			removeIncoming(G, dest, lastid);
+		}
+	}
+	free(inter);
+	return numchains;
+}
+
+// same as chainEdgeFlow in reverse time: given the capacities out[0..numout-1] (sorted by time) with which
+// flow can leave the dest node of chain edge e towards the sink, computes how much of each interaction
+// of e can reach the sink (later interactions of e are served first; flow arriving at t can leave after t)
+// writes the interactions of e with nonzero capacity to in (sorted by time) and returns their number
+static int chainEdgeCapacity(const struct Interaction *out, int numout, const struct Edge *e, struct Interaction *in)
+{
+	double buffer = 0.0;
+	int i = numout-1;
+	int n = 0;
+
+	for (int j=e->numinter-1; j>=0; j--) {
+		for (; i>=0 && out[i].timestamp > e->inter[j].timestamp; i--)
+			buffer += out[i].quantity;
+		double cap = (buffer < e->inter[j].quantity) ? buffer : e->inter[j].quantity;
+		buffer -= cap;
+		if (cap>0) {
+			in[n].timestamp = e->inter[j].timestamp;
+			in[n++].quantity = cap;
+		}
+	}
+	for (i=0; i<n/2; i++) { // found from the latest
+		struct Interaction tmp = in[i];
+		in[i] = in[n-1-i];
+		in[n-1-i] = tmp;
+	}
+	return n;
+}
+
+// series reduction at the sink: every chain u->x1->...->xk->sink (x1..xk have one incoming and one
+// outgoing edge) is replaced by an edge u->sink whose interactions are those of u->x1, each limited to
+// the flow the chain can take from it to the sink; this is the source chain reduction in reverse time
+// (the sink can take all flow until the end) and is exact as well; if u->sink exists, the chain is merged into it
+// returns the number of chains replaced
+static int reduceSinkChains(struct DAG *G, int *deletednodes, struct ReduceScratch *rs)
+{
+	int i,k;
+	int sink = G->numnodes-1;
+	int numchains = 0;
+	int numlast = G->node[sink].numinc;
+	int maxinter = 0;
+
+	// last edges of chains (into the sink); the list of incoming edges of the sink changes below
+	for (i=0; i<numlast; i++)
+		rs->chainfirst[i] = G->node[sink].incedges[i];
+	// a chain may grow when a merge leaves its first node with one outgoing edge, so the scratch
+	// arrays are sized for any edge (merges below only grow edges into the sink, which are not copied)
+	for (i=0; i<G->numedges; i++)
+		if (G->edgearray[i]->numinter > maxinter)
+			maxinter = G->edgearray[i]->numinter;
+	struct Interaction *cur = (struct Interaction *)malloc((maxinter+1)*sizeof(struct Interaction));
+	struct Interaction *next = (struct Interaction *)malloc((maxinter+1)*sizeof(struct Interaction));
+
+	for (i=0; i<numlast; i++)
+	{
+		int lastid = rs->chainfirst[i];
+		int x = G->edgearray[lastid]->src;
+		if (x==0 || deletednodes[x] || G->node[x].numinc!=1 || G->node[x].numout!=1)
+			continue; // not a chain
+		// walk back to the first node u that is not a chain node; capacities are computed on the way
+		const struct Interaction *out = G->edgearray[lastid]->inter;
+		int numout = G->edgearray[lastid]->numinter;
+		int firstid;
+		while (1) {
+			firstid = G->node[x].incedges[0];
+			deletednodes[x] = 1; //this node is going to be "deleted"
+			numout = chainEdgeCapacity(out, numout, G->edgearray[firstid], next);
+			struct Interaction *swap = cur;
+			cur = next;
+			next = swap;
+			out = cur;
+			x = G->edgearray[firstid]->src;
+			if (x==0 || deletednodes[x] || G->node[x].numinc!=1 || G->node[x].numout!=1)
+				break;
+		}
+		int u = x;
+		numchains++;
+
+		//check if edge u->sink exists
+		for (k=0; k<G->node[u].numout; k++)
+			if (G->edgearray[G->node[u].outedges[k]]->dest == sink)
+				break;
+		if (k==G->node[u].numout)
+		{
+			// edge does not exist: first edge of chain becomes u->sink and replaces the last one at the sink
+			struct Edge *e = G->edgearray[firstid];
+			e->dest = sink;
+			dropInteractions(e);
+			e->numinter = numout;
+			e->inter = cur;
+			ownInteractions(G, e, numout); // copied out of the scratch array
+			for (k=0; k<G->node[sink].numinc; k++)
+				if (G->node[sink].incedges[k]==lastid)
+					G->node[sink].incedges[k]=firstid;
+		}
+		else
+		{
+			// edge exists => merge; first edge of chain is deleted from u, last edge from the sink
+			mergeInteractions(G, G->edgearray[G->node[u].outedges[k]], cur, numout);
+			for (k=0; k<G->node[u].numout; k++)
+				if (G->node[u].outedges[k]==firstid)
+					break;
+			G->node[u].outedges[k]=G->node[u].outedges[--G->node[u].numout];
+			removeIncoming(G, sink, lastid);
+		}
+	}
+	free(cur);
+	free(next);
+	return numchains;
+}
+
+// parallel reduction: edges with the same src and dest are merged into the first of them
+// (interactions of parallel edges are independent, so the union has the same flow)
+// merged edges are marked in deletededges; returns their number
+static int mergeParallelEdges(struct DAG *G, int *deletednodes, int *deletededges, struct ReduceScratch *rs)
+{
+	int u,j;
+	int merged = 0;
+
+	for (u=0; u<G->numnodes; u++)
+		rs->seenby[u] = -1;
+	for (u=0; u<G->numnodes; u++) {
+		if (deletednodes[u])
+			continue;
+		for (j=0; j<G->node[u].numout; j++) {
+			int id = G->node[u].outedges[j];
+			int v = G->edgearray[id]->dest;
+			if (rs->seenby[v] != u) { // first edge u->v
+				rs->seenby[v] = u;
+				rs->seenedge[v] = id;
+				continue;
 			}
+			mergeInteractions(G, G->edgearray[rs->seenedge[v]], G->edgearray[id]->inter, G->edgearray[id]->numinter);
+			deletededges[id] = 1;
+			G->node[u].outedges[j--] = G->node[u].outedges[--G->node[u].numout];
+			removeIncoming(G, v, id);
+			merged++;
 		}
 	}
-	//printf("numpasses=%d\n",numpasses);
-	
-	// after DAG has been simplified by iteratively simplifying chains
+	return merged;
+}
+
+// reduces DAG G in place by series reductions at the source and at the sink (chains, see reduceSourceChains
+// and reduceSinkChains) and parallel-edge merges at all nodes, until none applies; all are exact, so the flow
+// of G is unchanged; a series reduction can enable a parallel merge and vice versa
+// chains between two other nodes are kept: their interactions cannot be replaced by those of one edge
+// removed nodes are marked in deletednodes, removed edges (other than those of removed nodes) in deletededges
+// (arrays of G->numnodes and G->numedges elements, initially 0); returns the number of reductions
+int reduceDAG(struct DAG *G, int *deletednodes, int *deletededges)
+{
+	struct ReduceScratch rs;
+	int numreductions = 0;
+	int changed = 1;
+
+	rs.chainedges = (struct Edge **)dagalloc(G, (G->numedges+1)*sizeof(struct Edge *));
+	rs.chainstart = (int *)dagalloc(G, (G->node[0].numout+1)*sizeof(int));
+	rs.chainfirst = (int *)dagalloc(G, (G->numedges+1)*sizeof(int));
+	rs.chainlast = (int *)dagalloc(G, (G->node[0].numout+1)*sizeof(int));
+	rs.interstart = (int *)dagalloc(G, (G->node[0].numout+1)*sizeof(int));
+	rs.chainflow = (double *)dagalloc(G, (G->node[0].numout+1)*sizeof(double));
+	rs.outpos = (int *)dagalloc(G, (G->numedges+1)*sizeof(int));
+	rs.seenby = (int *)dagalloc(G, G->numnodes*sizeof(int));
+	rs.seenedge = (int *)dagalloc(G, G->numnodes*sizeof(int));
+
+	while (changed) {
+		changed = reduceSourceChains(G, deletednodes, &rs);
+		changed += reduceSinkChains(G, deletednodes, &rs);
+		changed += mergeParallelEdges(G, deletednodes, deletededges, &rs);
+		numreductions += changed;
+	}
+
+	dagfree(G, rs.chainedges);
+	dagfree(G, rs.chainstart);
+	dagfree(G, rs.chainfirst);
+	dagfree(G, rs.chainlast);
+	dagfree(G, rs.interstart);
+	dagfree(G, rs.chainflow);
+	dagfree(G, rs.outpos);
+	dagfree(G, rs.seenby);
+	dagfree(G, rs.seenedge);
+	return numreductions;
+}
+
+// computes flow in DAG G by first reducing it (see reduceDAG)
+// after reduction the resulting DAG is solved using LP 
+double compFlow(struct DAG G, int writeDAG)
+{
+	int i;
+	double flow;
+	int *deletednodes = (int *)dagalloc(&G, G.numnodes*sizeof(int)); //marks "deleted" nodes
+	memset(deletednodes,0,G.numnodes*sizeof(int));
+	int *deletededges = (int *)dagalloc(&G, (G.numedges+1)*sizeof(int)); //marks merged edges
+	memset(deletededges,0,G.numedges*sizeof(int));
+
+	reduceDAG(&G, deletednodes, deletededges);
+
+	// after DAG has been reduced
 	// construct a new DAG for LP algorithm to solve	
 	
-	struct Edge **edgearray = (struct Edge **)malloc(G.numedges*sizeof(struct Edge *));
+	struct Edge **edgearray = (struct Edge **)dagalloc(&G, G.numedges*sizeof(struct Edge *));
 	int numedges =0;
 	
 	//add all edges that include a non-deleted node
 	int sourcepos = -1; //used to swap edges if first edge in edgearray is not from source
 	for (i=0; i<G.numedges; i++)
-		if (!deletednodes[G.edgearray[i]->src] && !deletednodes[G.edgearray[i]->dest])
+		if (!deletednodes[G.edgearray[i]->src] && !deletednodes[G.edgearray[i]->dest] && !deletededges[i])
 		{
 			//printf("adding edge %d: %d->%d\n",i, G.edgearray[i]->src,G.edgearray[i]->dest);
 			if (sourcepos == -1 && G.edgearray[i]->src==0)
@@ -2231,10 +2789,10 @@ double compFlow(struct DAG G, int writeDAG)
 	//printf("DAG reduced to %d nodes and %d edges\n",G.numnodes-numdelnodes,numedges);
 	if (numedges>1)
 	{
-		struct DAG *G2 = edgearray2DAG(edgearray, numedges, G.numnodes-1, 0);
+		struct DAG *G2 = edgearray2DAG(edgearray, numedges, G.numnodes-1, 0, G.arena);
 		//printDAG(G2);
 		if (writeDAG) writeDAGtofile(G2, "decompDAG.txt");
-		flow=computeFlowLP(*G2);
+		flow=computeFlowLPShared(*G2); // the reductions may give a node outgoing interactions at the same time
 		freeDAG(G2);
 	}
 	else // just a single edge; sum up all quantities on its interactions 
@@ -2244,184 +2802,13 @@ double compFlow(struct DAG G, int writeDAG)
 			flow += edgearray[0]->inter[i].quantity;
 	}
 	
-	free(deletednodes);
-	free(edgearray);
+	dagfree(&G, deletednodes);
+	dagfree(&G, deletededges);
+	dagfree(&G, edgearray);
 	
 	return flow;
 }
 
-/*
-// examines possible DAGs with same node as source and sink
-// takes source candidates from 2-hop loops file
-int runtestloops(struct Graph G, char *floops)
-{
-	int i,j,k;
-	FILE *f; // input file with 2-hop loops
-	FILE *fout; // output file 
-
-	char *line = NULL; // used for fileread
-	size_t len = 0; // used for fileread
-	ssize_t read; // used for fileread
-	const char delim[2] = " "; // used for fileread
-	char *token; // used for fileread
-	int numline = 0;
-	int numdags = 0;
-	
-	int prevsrc = -1;
-	
-	int source;
-	int sink;
-	int totinter;
-	
-	double flow;
-	
-	struct DAG *G2=NULL;
-	struct Edge** edgearray;
-	int numedges;
-	
-	int *order;
-	int numdeletedinter;
-	int numdeletededges;
-	int numdeletednodes;
-	struct DAG *retDAG=NULL;
-
-    clock_t t;
-    double time_taken;
-	
-	edgearray = (struct Edge **)malloc(MAXEDGES*sizeof(struct Edge *)); //this array holds all edges that exist in valid paths 
-	
-	f = fopen(floops,"r");
-	if (f==NULL)
-	{
-		printf("ERROR: file %s does not exist.\n",floops);
-		return -1;
-	}
-	
-	fout = fopen("newexps.txt","w");
-	fprintf(fout,"source\tsink\tnumnodes\tnumedges\ttotInteractions\tGreedyFlow\tGreedyTime\tLPFlow\tLPTime\tNumNodeDel\tNumEdgeDel\tNumInterDel\tPrepTime\tPreLPFlow\tPreLPTime\tPreSimLPFlow\tPreSimLPTime\n");
-	
-	// Read loops from file
-	while ((read = getline(&line,&len,f)) != -1)	{
-		numline++;
-		// next line to be read should be <src> <outdegree>
-		token = strtok(line,delim);
-		source = atoi(token);
-		if (source==prevsrc)
-			continue;
-		prevsrc = source;
-		numdags++;
-		printf("source: %d\n",source);
-		sink=source;
-		printf("sink: %d\n",sink);
-		fprintf(fout,"%d\t%d\t",source,sink); //write source to file
-		
-		totinter=findPaths2(G,source,sink,4,edgearray,&numedges); 
-		printf("numedges=%d, totinter=%d\n",numedges, totinter);
-		
-		G2 = edgearray2DAG(edgearray, numedges, sink, 0);
-		printf("numnodes=%d\n",G2->numnodes);
-		fprintf(fout,"%d\t%d\t%d\t",G2->numnodes,numedges,totinter); //write numnodes, numedges, numinter to file
-			
-		if (numedges==0) {
-			printf("No paths found\n");
-			return -1;
-		}
-		
-		// running simple Greedy
-		t = clock();    
-		flow=computeFlowGreedy(*G2);
-		t = clock() - t;
-    	time_taken = ((double)t)/CLOCKS_PER_SEC;
-    	printf("Gr: %f flow, in %f seconds\n", flow, time_taken);
-		fprintf(fout,"%f\t%f\t",flow, time_taken);
-
-		// running LP		
-		t = clock();    
-		if (totinter<10000) //run LP only if number of interactions is not extremely large
-		//if (totinter<0) 
-			flow=computeFlowLP(*G2);
-		else
-			flow = -1;
-		t = clock() - t;
-    	time_taken = ((double)t)/CLOCKS_PER_SEC;
-    	printf("LP: %f flow, in %f seconds\n", flow, time_taken);
-    	fprintf(fout,"%f\t%f\t",flow, time_taken);
-
-		// running preprocessingDAG (without flow computation)
-		order = topoorder(G2);	
-		if (order) {
-			numdeletedinter = 0;
-			numdeletededges = 0;
-			numdeletednodes = 0;	
-			t = clock(); 
-			retDAG = preprocessDAG(G2, order, &numdeletedinter, &numdeletededges, &numdeletednodes);
-			t = clock() - t;
-			time_taken = ((double)t)/CLOCKS_PER_SEC;
-			printf("Preprocessing time: %f seconds\n", time_taken);
-			printf("Total deletions: interactions=%d, edges=%d, nodes=%d\n",numdeletedinter,numdeletededges,numdeletednodes);
-			fprintf(fout,"%d\t%d\t%d\t%f\t",numdeletednodes, numdeletededges, numdeletedinter, time_taken);
-
-			if(retDAG==NULL)
-			{
-				printf("DAG has no flow: sink disconnected\n");
-				fprintf(fout,"%f\t%f\t",0.0, 0.0);
-				fprintf(fout,"%f\t%f\n",0.0, 0.0);
-			}
-			else if (totinter<10000) { //run LP only if number of interactions is not extremely large
-				// LP after preprocessing
-				t = clock();    
-				flow=computeFlowLP(*retDAG);
-				t = clock() - t;
-				time_taken = ((double)t)/CLOCKS_PER_SEC;
-				printf("PreLP: %f flow, in %f seconds\n", flow, time_taken);
-				fprintf(fout,"%f\t%f\t",flow, time_taken);
-					
-				// LP after preprocessing and DAG simplification
-				t = clock(); 
-				flow=compFlow(*retDAG);
-				t = clock() - t;
-				time_taken = ((double)t)/CLOCKS_PER_SEC;
-				printf("PreSimLP: %f flow, in %f seconds\n", flow, time_taken);
-				fprintf(fout,"%f\t%f\n",flow, time_taken);
-			}
-			else 
-			{
-				fprintf(fout,"%f\t%f\t",-1.0, 0.0);
-				fprintf(fout,"%f\t%f\n",-1.0, 0.0);
-			}
-	
-			free(order);
-
-			if (retDAG != NULL) {
-				freeDAG(retDAG);
-			}
-		}
-		else {
-			fprintf(fout,"%d\t%d\t%d\t%f\t",0, 0, 0, 0.0);
-			fprintf(fout,"%f\t%f\t",0.0, 0.0);
-			fprintf(fout,"%f\t%f\n",0.0, 0.0);		
-		}
-			
-    	//free(edgearray);
-    
-		//fprintf(fout,"%d\t%d\t%d\t%d\t%d\t%f\t%f\t%f\t%f\t%f\t%f\n",source,sink,G2->numnodes,numedges,totinter,flow1,time_taken1,flow2,time_taken2,flow3,time_taken3);
-		fflush(fout);
-
-		if (G2 != retDAG && G2 != NULL) {
-			freeDAG(G2);
-			G2=NULL;
-		}
-
-		//if (!(numdags%100))
-		//	break;
-		//printf("source: %d\n",src);		
-	}
-	fclose(fout);
-	free(edgearray);
-	return 0;
-}
-*/
-
 /*
 int main(int argc, char **argv)
 {
@@ -2578,7 +2965,7 @@ int main(int argc, char **argv)
 
 	//convert edgearray to DAG
 	
-	G2 = edgearray2DAG(edgearray, numedges, sink, 1);
+	G2 = edgearray2DAG(edgearray, numedges, sink, 1, NULL);
 	printf("numnodes=%d\n",G2->numnodes);
 	//printDAG(G2);
 	//return -1;
@@ -2634,7 +3021,7 @@ int main(int argc, char **argv)
 			writeDAGtofile(retDAG, "retDAG.txt");
 			printf("LP after pre is running \n");
 			t = clock();    
-			flow=computeFlowLP(*retDAG);
+			flow=computeFlowLPShared(*retDAG);
 			printf("Computed flow: %f\n", flow);
 			t = clock() - t;
 			time_taken = ((double)t)/CLOCKS_PER_SEC;
@@ -6,50 +6,81 @@
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <limits.h>
+#include <stdint.h>
+#include <sys/mman.h>
 #include "lp_lib.h"
+#include "arena.h"
 
 #define MAXINSTANCES 1000000
 #define MAXFLOW 10000000000
 #define MAXTIME 1000000000000
 
-#define MAXEDGES 10000 //max number of edges in a custom DAG extracted from the graph -> can cause seg.faults
+#define MAXEDGES 10000 //max number of edges in a custom DAG extracted by findPaths3 (findPaths2 has no limit) -> can cause seg.faults
 #define MAXEDGESPATH 100 //max number of edges in a path DAG extracted from the graph (decomp)
 //#define MAXOUT 1000 //max number of outgoing edges in a node of a custom DAG extracted from the graph
 //#define MAXIN 1000 //max number of outgoing edges in a node of a custom DAG extracted from the graph
 #define MAXINTER 10000
 #define MAXNODES 10000 //max number of nodes in a DAG
+#define MAXLPINTER 10000 //LP is run only on DAGs with fewer interactions
+#define LPMODEL_INTER 0 // LP of the paper: every outgoing interaction of a node is bounded separately by the node's buffer
+#define LPMODEL_SHARED 1 // outgoing interactions of a node at the same time share its buffer (exact, see maxflow.h)
+#define RADIXMIN 64 //timelines with fewer events are sorted by insertion instead of radix sort (see buildTimeline)
 
 struct DAG {
     int numnodes; // number of nodes in DAG
 	struct DAGNode* node; // keeps track of incoming and outgoing edges to a node
     int numedges; // number of edges in DAG
     struct Edge **edgearray; // array of all DAG's edges (with their interactions)
+    struct Edge *edges; // block holding the edges of edgearray
+    int *adjpool; // block holding incedges and outedges of all nodes
+    struct Arena *arena; // arena that holds the DAG and all its buffers, NULL if they are malloc'd (see dagalloc)
 };
 
 struct DAGNode {
 	int label; // should be equal to the order of the node in the DAGNode array of the DAG
     int numinc; // number of incoming edges to this node
     int numout; // number of outgoing edges from this node
-    int *incedges; // indices to incoming edges in edgearray of DAG
-    int *outedges; // indices to outgoing edges in edgearray of DAG
+    int *incedges; // indices to incoming edges in edgearray of DAG (position in DAG.adjpool)
+    int *outedges; // indices to outgoing edges in edgearray of DAG (position in DAG.adjpool)
 };
 
+// hash map from graph node ids to DAG ids, used by edgearray2DAG (empty slots have key -1)
+struct NodeMap {
+	int *key;
+	int *val;
+	int tablesize; // power of 2
+};
+
+// graph in compressed-sparse-row layout:
+// outgoing edges of all nodes are stored node after node in one edge pool and 
+// interactions of all edges are stored edge after edge in one interaction pool
 struct Graph {
 	int numnodes;
 	struct Node* node;
+	long long numedges; // number of edges in pool
+	long long numinter; // number of interactions in pool
+	struct Edge* edges; // pool of all edges
+	struct EdgeSummary* summary; // summary[k] summarizes edges[k] (points into mapped file for binary graphs)
+	struct Interaction* inter; // pool of all interactions (points into mapped file for binary graphs)
+	long long *incoff; // incoming edges of node i are incedges[incoff[i]..incoff[i+1]-1]
+	struct Edge** incedges; // incoming-edge index: pointers into the edge pool, grouped by dest (see indexIncomingEdges)
+	void *mapaddr; // memory-mapped binary graph file (see graphbin.h), NULL if graph was parsed from text
+	size_t maplen; // length of mapped region
 };
 
 struct Edge {
 	int src;
 	int dest;
 	int numinter;
-	struct Interaction* inter;
+	int owninter; // 1 if inter was allocated for this edge and is freed with it, 0 if it views interactions stored elsewhere
+	struct Interaction* inter; // first interaction of edge; for graph edges, a position in the graph's interaction pool
 };
 
 struct Node {
 	int label;
 	int numout;
-	struct Edge* edge;
+	struct Edge* edge; // first outgoing edge; for graph nodes, a position in the graph's edge pool
 };
 
 struct Interaction {
@@ -57,12 +88,90 @@ struct Interaction {
 	double quantity;
 };
 
+// interaction of a DAG edge as an event of the DAG's timeline (see buildTimeline)
+// it carries what the greedy algorithm needs, so that the flow pass does not touch the edges
+struct FlowEvent {
+	double timestamp;
+	double quantity;
+	int src; // buffer the flow is taken from
+	int dest; // buffer the flow is added to
+};
+
+// summary of the interactions of a graph edge; lets path searches and bounds decide
+// without touching the interaction pool
+struct EdgeSummary {
+	double mintime; // timestamp of first interaction
+	double maxtime; // timestamp of last interaction
+	double totqty; // total quantity of all interactions
+	int numinter;
+	int pad; // keeps the record 8-byte aligned (it is stored as is in binary graph files)
+};
+
 
 struct CPattern {
 	int numnodes;
 	int *labels;
 };
 
+// set of distinct edges (pointers into a graph's edge pool), kept in insertion order
+// an open-addressing hash table on the pointers makes membership tests O(1); both grow as needed
+struct EdgeSet {
+	struct Edge **edge; // edges in insertion order
+	int numedges;
+	int maxedges; // capacity of edge
+	struct Edge **table; // hash table (NULL = empty slot), at most half full
+	int tablesize; // power of 2
+};
+
+// edge kept in the dynamic topological order of findPaths2, linked into the out-list of its
+// source and the in-list of its destination
+struct OrderEdge {
+	int src;
+	int dest;
+	int prevout; // neighbours in out-list of src (-1 at the ends); nextout also links free records
+	int nextout;
+	int previn; // neighbours in in-list of dest
+	int nextin;
+};
+
+// node with its position in the topological order (used for reordering)
+struct OrderedNode {
+	int ord;
+	int node;
+};
+
+// per-query scratch space of findPaths2, sized for a graph and reused between queries
+// (one per thread); visited marks and node orders are valid only if stamped with the
+// current epoch/query number, so they never have to be cleared
+struct PathScratch {
+	int numnodes;
+	int *mark; // mark[u] == epoch: u visited by current search
+	int epoch;
+	int *stack; // nodes to visit in searches
+	int *ord; // position of u in topological order of kept edges, valid if ordstamp[u] == query
+	int *ordstamp;
+	int *outhead; // first record of out-list/in-list of u (same validity as ord)
+	int *inhead;
+	int query;
+	int numord; // number of nodes with a position in current query
+	struct OrderEdge *recs; // edge records
+	int numrecs;
+	int maxrecs;
+	int freerec; // first free record, -1 if none
+	struct OrderedNode *deltaF; // nodes affected by a reordering
+	struct OrderedNode *deltaB;
+	int *ordpool;
+	int maxdelta; // capacity of deltaF, deltaB (ordpool: twice)
+	int maxlen; // capacity of the path arrays
+	struct Edge **curedges; // edges of current path
+	int *node; // nodes of current path
+	int *nextedge; // next out-edge to expand for every node of current path
+	int *rec; // order record of every edge of current path (-1 if none or kept by es)
+	double *arrival; // earliest time flow can arrive at every node of current path
+	int *dist; // hop distance of u to destnode, valid if diststamp[u] == query (see labelDistances)
+	int *diststamp;
+};
+
 struct CompleteInteraction {
     int src;
     int dest;
@@ -70,6 +179,22 @@ struct CompleteInteraction {
     double quantity;
 };
 
+// interaction of a node's time-sorted list (index to the interaction array of an LPModel)
+struct TimedIndex {
+    double timestamp;
+    int idx;
+};
+
+// LP model of the flow problem on a DAG, built by buildFlowLP
+struct LPModel {
+    lprec *lp;
+    int Ncol; // number of variables (interactions not leaving the source)
+    int totinter; // number of interactions, including those from source
+    struct CompleteInteraction *inters; // complete list of interactions in DAG
+    int *map; // map[i] = variable-id corresponding to interaction i, -1 for interactions from source
+    int *revmap; // revmap[i] = interaction-id corresponding to variable i
+};
+
 void printpath(struct CPattern path, int len);
 void fprintpath(FILE *fp, struct CPattern path, int len, double flow);
 
@@ -91,13 +216,28 @@ int read_graph(struct Graph *G, FILE *f);
 // prints graph (for debugging purposes)
 void printGraph(struct Graph *G);
 
-// converts edgearray to DAG
-struct DAG *edgearray2DAG(struct Edge** edgearray, int numedges, int sink, int writefile);
+// computes the summary of the interactions of edge e (interactions are sorted by time)
+void summarizeEdge(struct Edge *e, struct EdgeSummary *s);
+
+// builds the incoming-edge index of G (incoff, incedges); called by the graph readers
+void indexIncomingEdges(struct Graph *G);
+
+// frees memory allocated by read_graph or read_graph_bin
+void freeGraph(struct Graph *G);
+
+// converts edgearray to DAG; the DAG is allocated from arena (NULL: malloc)
+struct DAG *edgearray2DAG(struct Edge** edgearray, int numedges, int sink, int writefile, struct Arena *arena);
+
+// allocates size bytes for DAG G: from G's arena if it has one, else with malloc
+void *dagalloc(struct DAG *G, size_t size);
+// frees a block of dagalloc (blocks of an arena are released by resetArena instead)
+void dagfree(struct DAG *G, void *p);
 
 // returns in an array the positions of nodes of the DAG in topological order
 int* topoorder(struct DAG *G);
 
 // accesses DAG in topological order "*order" and removes interactions that cannot contribute to flow
+// (forward and backward passes, repeated until nothing changes)
 struct DAG *preprocessDAG(struct DAG *G, int *order, int *numdeletedinter, int *numdeletededges, int *numdeletednodes);
 
 // suboptimal way to find the edge with the currently minimum timestamp
@@ -108,16 +248,47 @@ int find_minedge(struct Edge **edgearray, int numedges, int *ptr);
 // measures the flow along the path
 double processInstanceChain(struct Graph G, int *instance, int numnodes);
 
+// returns the interactions of edgearray[0..numedges-1] as events sorted by time (ties by edge
+// position, then by position in the edge, i.e. the order in which find_minedge visits them)
+// the array is allocated with dagalloc if G is not NULL, with malloc otherwise; *numevents holds its size
+struct FlowEvent *buildTimeline(struct DAG *G, struct Edge **edgearray, int numedges, int *numevents);
+
 // computes the flow throughout a DAG from its source (node at position 0) 
 double computeFlowGreedyOld(struct DAG G);
 double computeFlowGreedy(struct DAG G);
+// same greedy algorithm with a cache-aligned 4-ary heap; ties between edges are taken in the order
+// of that heap, so the flow may differ from computeFlowGreedy
+double computeFlowGreedyHeap4(struct DAG G);
+// same greedy algorithm as one pass over the DAG's timeline, without a heap; ties between edges
+// are visited in edge order (as in computeFlowGreedyOld), so the flow may differ from computeFlowGreedy
+double computeFlowGreedyTimeline(struct DAG G);
 
 // same as computeFlowGreedy BUT records all incoming interactions to sink, which accumulate to total flow
 double computeFlowGreedyWithInterOld(struct DAG G, struct Interaction **inter, int *numinter);
 double computeFlowGreedyWithInter(struct DAG G, struct Interaction **inter, int *numinter);
+double computeFlowGreedyTimelineWithInter(struct DAG G, struct Interaction **inter, int *numinter);
 
-// computes the flow throughout a DAG from its source (node at position 0) 
+//compare two interactions of a node by time; used by qsort call in function buildFlowLP
+int compTimedIndex(const void *a, const void *b);
+
+// builds the LP model of the flow problem on DAG G with model LPMODEL_INTER or LPMODEL_SHARED;
+// only nonzero coefficients are added and interaction quantities become column bounds
+// returns 0 on success, error code otherwise (the model should be freed with freeFlowLP in both cases)
+int buildFlowLP(struct DAG G, int model, struct LPModel *m);
+
+// frees the LP model built by buildFlowLP
+void freeFlowLP(struct LPModel *m);
+
+// computes the flow throughout a DAG from its source (node at position 0) with the LP of the paper
+// (LPMODEL_INTER); it can exceed the max flow on nodes with several outgoing interactions at the same time
 double computeFlowLP(struct DAG G);
+// same as computeFlowLP with model LPMODEL_SHARED; equals computeFlowMaxflow
+double computeFlowLPShared(struct DAG G);
+
+// same as computeFlowLP with LP model model, but lp_solve gives up after timeout seconds (0: no limit)
+// *optimal is 1 if the LP was solved; else the flow of the best solution found in time is returned
+// (a lower bound of the flow), or -1 if there is none
+double computeFlowLPTimed(struct DAG G, int model, long timeout, int *optimal);
 
 //compare two interactions by time; used by qsort call in function computeFlowLPWithInter
 int compInter(const void *a, const void *b);
@@ -125,15 +296,38 @@ int compInter(const void *a, const void *b);
 // same as computeFlowLP; returns incoming interactions to sink, which accumulate to total flow
 double computeFlowLPWithInter(struct DAG G, struct Interaction **inter, int *numinter);
 
+// set of distinct graph edges, used to collect the edges of all paths found by findPaths2
+void initEdgeSet(struct EdgeSet *es);
+// adds e to es unless it is already there; returns 1 if e was added, 0 otherwise
+int addToEdgeSet(struct EdgeSet *es, struct Edge *e);
+// returns 1 if e is in es, 0 otherwise
+int inEdgeSet(struct EdgeSet *es, struct Edge *e);
+// removes all edges from es; memory is kept for the next query
+void clearEdgeSet(struct EdgeSet *es);
+void freeEdgeSet(struct EdgeSet *es);
+
+// allocates scratch space for path queries on a graph with numnodes nodes
+void initPathScratch(struct PathScratch *ps, int numnodes);
+void freePathScratch(struct PathScratch *ps);
+
 // finds all paths from sourcenode to destnode up to a maximum length;
-int findPaths2(struct Graph G, int sourcenode, int destnode, int maxlen, struct Edge** edgearray, int *numedges);
+// their distinct edges are collected in es (in order of discovery); returns their number of interactions
+int findPaths2(struct Graph G, int sourcenode, int destnode, int maxlen, struct EdgeSet *es, struct PathScratch *ps);
 int findPaths3(struct Graph G, int sourcenode, int destnode, int maxlen, struct Edge** edgearray, int *numedges);
 
 
 // takes as input an edgearray where edges are ordered by direction
 double simplifyChain(struct Edge **edgearray, int numedges, struct Interaction **inter, int *numinter);
+// same as simplifyChain for numchains chains at once: chain c is edgearray[chainstart[c]..chainstart[c+1]-1],
+// its interactions into the sink are (*inter)[interstart[c]..interstart[c+1]-1] and its flow is flow[c]
+void simplifyChains(struct Edge **edgearray, int *chainstart, int numchains, double *flow, struct Interaction **inter, int *interstart);
+
+// reduces DAG G in place by series reductions at the source and the sink and parallel-edge merges, until none applies
+// removed nodes/edges are marked in deletednodes/deletededges (initially 0); returns the number of reductions
+int reduceDAG(struct DAG *G, int *deletednodes, int *deletededges);
 
-// computes flow in DAG G by first finding all reducible chains from the source node
+// computes flow in DAG G by first reducing it (see reduceDAG), then solving the rest with LP (LPMODEL_SHARED:
+// the reductions are exact for the shared buffers of the max-flow, but can create same-time interactions)
 double compFlow(struct DAG G, int writeDAG);
 
 #endif // __COMPFLOW
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include <pthread.h>
+#include "computeflow.h"
+#include "query.h"
+#include "maxflow.h"
+#include "bounds.h"
+#include "planner.h"
+
+// batch mode: examines the DAGs with the same node as source and sink for many candidate sources
+// (e.g. taken from a 2-hop loops file) and writes one row per source to a results table
+// the graph is loaded once and shared read-only by a pool of worker threads;
+// DAG sizes differ by orders of magnitude between sources, so idle workers steal work
+
+#define OUTBUFSIZE 65536 // per-worker output is written to the results file in blocks of this size
+
+// a worker's queue of sources: positions [head,tail) of the shared source array
+// the owner takes sources from the head, thieves take the upper half of the range
+struct WorkQueue {
+	pthread_mutex_t lock;
+	int head;
+	int tail;
+};
+
+struct Worker {
+	int id;
+	struct Graph *G;
+	int *sources; // shared by all workers, read-only
+	struct WorkQueue *queues; // queues of all workers
+	int numworkers;
+	int maxlen;
+	const struct CostModel *cm; // cost model of the planner, shared read-only
+	struct EdgeSet es; // scratch space for findPaths2
+	struct PathScratch ps;
+	struct Arena arena; // memory of the current source's DAGs, reset after every source
+	char *outbuf; // rows not yet written to the results file
+	int outlen;
+	FILE *fout; // results file, shared
+	pthread_mutex_t *outlock;
+	int numdags; // statistics
+	int numstolen;
+};
+
+// returns the next source position of worker w, stealing from other workers if its queue is empty
+// returns -1 if no work is left
+static int nextsource(struct Worker *w)
+{
+	struct WorkQueue *q = &w->queues[w->id];
+	int pos = -1;
+
+	pthread_mutex_lock(&q->lock);
+	if (q->head < q->tail)
+		pos = q->head++;
+	pthread_mutex_unlock(&q->lock);
+	if (pos != -1)
+		return pos;
+
+	// own queue is empty: steal the upper half of the first non-empty queue found
+	for (int i=1; i<w->numworkers; i++) {
+		struct WorkQueue *v = &w->queues[(w->id+i)%w->numworkers];
+		int head = 0;
+		int tail = 0;
+		pthread_mutex_lock(&v->lock);
+		if (v->head < v->tail) {
+			tail = v->tail;
+			head = v->head + (v->tail-v->head)/2;
+			v->tail = head;
+		}
+		pthread_mutex_unlock(&v->lock);
+		if (head < tail) {
+			w->numstolen += tail-head;
+			pthread_mutex_lock(&q->lock);
+			q->head = head+1;
+			q->tail = tail;
+			pthread_mutex_unlock(&q->lock);
+			return head;
+		}
+	}
+	return -1;
+}
+
+// writes the buffered rows of worker w to the results file
+static void flushrows(struct Worker *w)
+{
+	if (w->outlen==0)
+		return;
+	pthread_mutex_lock(w->outlock);
+	fwrite(w->outbuf,1,w->outlen,w->fout);
+	pthread_mutex_unlock(w->outlock);
+	w->outlen = 0;
+}
+
+// appends a row to the output buffer of worker w
+static void addrow(struct Worker *w, const char *row, int len)
+{
+	if (w->outlen+len > OUTBUFSIZE)
+		flushrows(w);
+	memcpy(w->outbuf+w->outlen,row,len);
+	w->outlen += len;
+}
+
+// runs all algorithms on the DAG of one source and adds its row to the output buffer
+// the columns are those of the old runtestloops table, followed by max-flow and the flow bounds;
+// if the bounds decide the flow, the LP columns hold the decided flow and a time of 0 (no LP is solved)
+// the planner runs last on its own copy of the DAG; its predicted and actual times are logged to recalibrate the cost model
+static void runsource(struct Worker *w, int source)
+{
+	int sink = source;
+	int numedges;
+	double flow;
+	double t;
+	struct DAG *G2;
+	struct DAG *retDAG = NULL;
+	char row[1024];
+	int n;
+
+	n = sprintf(row,"%d\t%d\t",source,sink);
+	int totinter = findPaths2(*w->G,source,sink,w->maxlen,&w->es,&w->ps);
+	numedges = w->es.numedges;
+	if (numedges==0) { // no loops through source: empty DAG
+		n += sprintf(row+n,"%d\t%d\t%d\t",0,0,0);
+		n += sprintf(row+n,"%f\t%f\t%f\t%f\t",0.0,0.0,0.0,0.0);
+		n += sprintf(row+n,"%d\t%d\t%d\t%f\t",0,0,0,0.0);
+		n += sprintf(row+n,"%f\t%f\t%f\t%f\t",0.0,0.0,0.0,0.0);
+		n += sprintf(row+n,"%f\t%f\t",0.0,0.0);
+		n += sprintf(row+n,"%f\t%f\t%f\t",0.0,0.0,0.0);
+		n += sprintf(row+n,"%d\t%s\t%f\t%f\t%f\t%f\n",0,"none",0.0,0.0,0.0,0.0);
+		addrow(w,row,n);
+		return;
+	}
+	G2 = edgearray2DAG(w->es.edge, numedges, sink, 0, &w->arena);
+	n += sprintf(row+n,"%d\t%d\t%d\t",G2->numnodes,numedges,totinter);
+	w->numdags++;
+
+	// running simple Greedy
+	t = walltime();
+	flow = computeFlowGreedy(*G2);
+	n += sprintf(row+n,"%f\t%f\t",flow,walltime()-t);
+
+	// flow bounds; if they meet, no LP is needed
+	struct FlowBounds b;
+	t = walltime();
+	if (computeFlowBounds(G2, &b)==-1) // not a DAG
+		b.lower = b.upper = -1;
+	int decided = (b.upper != -1 && boundsDecided(&b));
+	double btime = walltime()-t;
+
+	// running LP
+	t = walltime();
+	if (decided)
+		flow = b.lower;
+	else if (totinter<MAXLPINTER) //run LP only if number of interactions is not extremely large
+		flow = computeFlowLP(*G2);
+	else
+		flow = -1;
+	n += sprintf(row+n,"%f\t%f\t",flow,decided ? 0.0 : walltime()-t);
+
+	// running max-flow (no size limit); printed in the last columns
+	t = walltime();
+	double mfflow = computeFlowMaxflow(*G2);
+	double mftime = walltime()-t;
+
+	// running preprocessingDAG (without flow computation)
+	int *order = topoorder(G2);
+	if (order) {
+		int numdeletedinter = 0;
+		int numdeletededges = 0;
+		int numdeletednodes = 0;
+		t = walltime();
+		retDAG = preprocessDAG(G2, order, &numdeletedinter, &numdeletededges, &numdeletednodes);
+		n += sprintf(row+n,"%d\t%d\t%d\t%f\t",numdeletednodes,numdeletededges,numdeletedinter,walltime()-t);
+
+		if (retDAG==NULL) // DAG has no flow: sink disconnected
+			n += sprintf(row+n,"%f\t%f\t%f\t%f\t",0.0,0.0,0.0,0.0);
+		else if (decided)
+			n += sprintf(row+n,"%f\t%f\t%f\t%f\t",b.lower,0.0,b.lower,0.0);
+		else if (totinter<MAXLPINTER) { //run LP only if number of interactions is not extremely large
+			// LP after preprocessing
+			t = walltime();
+			flow = computeFlowLPShared(*retDAG); // preprocessing keeps the max flow, not the flow of computeFlowLP
+			n += sprintf(row+n,"%f\t%f\t",flow,walltime()-t);
+
+			// LP after preprocessing and DAG simplification
+			t = walltime();
+			flow = compFlow(*retDAG, 0);
+			n += sprintf(row+n,"%f\t%f\t",flow,walltime()-t);
+		}
+		else
+			n += sprintf(row+n,"%f\t%f\t%f\t%f\t",-1.0,0.0,-1.0,0.0);
+		free(order);
+	}
+	else {
+		n += sprintf(row+n,"%d\t%d\t%d\t%f\t",0,0,0,0.0);
+		n += sprintf(row+n,"%f\t%f\t%f\t%f\t",0.0,0.0,0.0,0.0);
+	}
+	n += sprintf(row+n,"%f\t%f\t",mfflow,mftime);
+	n += sprintf(row+n,"%f\t%f\t%f\t",b.lower,b.upper,btime);
+
+	// running the planner on a fresh DAG (G2 was preprocessed in place)
+	struct DAG *G3 = edgearray2DAG(w->es.edge, numedges, sink, 0, &w->arena);
+	struct FlowPlan p;
+	if (planFlow(G3, w->cm, &p)==-1) // not a DAG
+		n += sprintf(row+n,"%d\t%s\t%f\t%f\t%f\t%f\n",0,"none",0.0,0.0,0.0,-1.0);
+	else
+		n += sprintf(row+n,"%d\t%s\t%f\t%f\t%f\t%f\n",p.stats.numchain,plan_name(p.plan),p.predicted[p.plan],p.statstime,p.actual,p.flow);
+	addrow(w,row,n);
+
+	if (retDAG != NULL && retDAG != G2)
+		freeDAG(retDAG);
+	freeDAG(G2);
+	freeDAG(G3);
+	resetArena(&w->arena);
+}
+
+static void *worker(void *arg)
+{
+	struct Worker *w = (struct Worker *)arg;
+	int pos;
+
+	while ((pos = nextsource(w)) != -1)
+		runsource(w, w->sources[pos]);
+	flushrows(w);
+	return NULL;
+}
+
+// reads candidate sources: first number of each line; consecutive repetitions are skipped
+// (loops file lists all 2-hop loops of a source in consecutive lines)
+// returns number of sources, -1 on error
+static int read_sources(char *filename, int **sources)
+{
+	char *line = NULL; // used for fileread
+	size_t len = 0; // used for fileread
+	const char delim[4] = " \t\n"; // used for fileread
+	char *token; // used for fileread
+	int prevsrc = -1;
+	int numsources = 0;
+	int maxsources = 1024;
+
+	FILE *f = fopen(filename,"r");
+	if (f==NULL)
+	{
+		printf("ERROR: file %s does not exist.\n",filename);
+		return -1;
+	}
+	*sources = (int *)malloc(maxsources*sizeof(int));
+	while (getline(&line,&len,f) != -1) {
+		token = strtok(line,delim);
+		if (token==NULL)
+			continue;
+		int source = atoi(token);
+		if (source==prevsrc)
+			continue;
+		prevsrc = source;
+		if (numsources==maxsources) {
+			maxsources *= 2;
+			*sources = (int *)realloc(*sources,maxsources*sizeof(int));
+		}
+		(*sources)[numsources++] = source;
+	}
+	if (line)
+		free(line);
+	fclose(f);
+	return numsources;
+}
+
+int main(int argc, char **argv)
+{
+	struct Graph G;
+	int *sources;
+	int i;
+
+	if (argc < 4 || argc > 7)
+	{
+		printf("graph filename, sources filename and output filename expected as arguments (optionally followed by number of threads, maximum path length and cost model filename). Exiting...\n");
+		return -1;
+	}
+	int numworkers = (argc > 4) ? atoi(argv[4]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	int maxlen = (argc > 5) ? atoi(argv[5]) : 4;
+	if (numworkers<1)
+		numworkers = 1;
+	struct CostModel cm;
+	initCostModel(&cm);
+	if (argc > 6 && readCostModel(&cm, argv[6])==-1)
+		return -1;
+
+	if (load_graph(&G, argv[1], numworkers)==-1)
+		return -1;
+	int numsources = read_sources(argv[2], &sources);
+	if (numsources==-1)
+		return -1;
+	for (i=0; i<numsources; i++)
+		if (sources[i]<0 || sources[i]>=G.numnodes) {
+			printf("ERROR: source %d is not a node of the graph. Exiting...\n",sources[i]);
+			return -1;
+		}
+
+	FILE *fout = fopen(argv[3],"w");
+	if (fout==NULL)
+	{
+		printf("ERROR: cannot create file %s. Exiting...\n",argv[3]);
+		return -1;
+	}
+	fprintf(fout,"source\tsink\tnumnodes\tnumedges\ttotInteractions\tGreedyFlow\tGreedyTime\tLPFlow\tLPTime\tNumNodeDel\tNumEdgeDel\tNumInterDel\tPrepTime\tPreLPFlow\tPreLPTime\tPreSimLPFlow\tPreSimLPTime\tMaxflowFlow\tMaxflowTime\tLowerBound\tUpperBound\tBoundTime\tChainNodes\tPlan\tPlanPredicted\tPlanStatsTime\tPlanTime\tPlanFlow\n");
+
+	// sources are dealt to the workers in contiguous ranges
+	pthread_mutex_t outlock = PTHREAD_MUTEX_INITIALIZER;
+	struct WorkQueue *queues = (struct WorkQueue *)malloc(numworkers*sizeof(struct WorkQueue));
+	struct Worker *workers = (struct Worker *)calloc(numworkers,sizeof(struct Worker));
+	pthread_t *tid = (pthread_t *)malloc(numworkers*sizeof(pthread_t));
+	for (i=0; i<numworkers; i++) {
+		pthread_mutex_init(&queues[i].lock,NULL);
+		queues[i].head = (int)((long long)numsources*i/numworkers);
+		queues[i].tail = (int)((long long)numsources*(i+1)/numworkers);
+		workers[i].id = i;
+		workers[i].G = &G;
+		workers[i].sources = sources;
+		workers[i].queues = queues;
+		workers[i].numworkers = numworkers;
+		workers[i].maxlen = maxlen;
+		workers[i].cm = &cm;
+		initEdgeSet(&workers[i].es);
+		initPathScratch(&workers[i].ps, G.numnodes);
+		initArena(&workers[i].arena);
+		workers[i].outbuf = (char *)malloc(OUTBUFSIZE);
+		workers[i].fout = fout;
+		workers[i].outlock = &outlock;
+	}
+
+	double t = walltime();
+	for (i=1; i<numworkers; i++)
+		pthread_create(&tid[i],NULL,worker,&workers[i]);
+	worker(&workers[0]);
+	for (i=1; i<numworkers; i++)
+		pthread_join(tid[i],NULL);
+	t = walltime()-t;
+
+	int numdags = 0;
+	int numstolen = 0;
+	for (i=0; i<numworkers; i++) {
+		numdags += workers[i].numdags;
+		numstolen += workers[i].numstolen;
+		freeEdgeSet(&workers[i].es);
+		freePathScratch(&workers[i].ps);
+		freeArena(&workers[i].arena);
+		free(workers[i].outbuf);
+		pthread_mutex_destroy(&queues[i].lock);
+	}
+	printf("sources=%d, DAGs=%d, threads=%d, stolen sources=%d\n",numsources,numdags,numworkers,numstolen);
+	printf("Total time of execution: %f seconds\n",t);
+
+	fclose(fout);
+	free(workers);
+	free(queues);
+	free(tid);
+	free(sources);
+	freeGraph(&G);
+	return 0;
+}
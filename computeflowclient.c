@@ -0,0 +1,85 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// replays a file of vertex ids against a running computeflowserver and measures query throughput
+// each line of the vertex file starts with a vertex id (further fields are ignored)
+// server replies are written to stdout, a summary to stderr
+int main(int argc, char **argv)
+{
+	char *line = NULL; // used for fileread
+	size_t len = 0; // used for fileread
+	char *reply = NULL;
+	size_t replylen = 0;
+	const char delim[4] = " \t\n"; // used for fileread
+	char *token; // used for fileread
+	struct sockaddr_un addr;
+	struct timespec t0, t1;
+	int numqueries = 0;
+	int numerrors = 0;
+
+	if (argc < 3 || argc > 6)
+	{
+		printf("socket path and vertex file expected as arguments (optionally followed by maxlen, algorithm and LP timeout in seconds). Exiting...\n");
+		return -1;
+	}
+	int maxlen = (argc > 3) ? atoi(argv[3]) : 4;
+	char *algo = (argc > 4) ? argv[4] : "greedy";
+	long lptimeout = (argc > 5) ? atol(argv[5]) : 0;
+
+	FILE *f = fopen(argv[2],"r");
+	if (f==NULL)
+	{
+		printf("ERROR: file %s does not exist. Exiting...\n",argv[2]);
+		return -1;
+	}
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	memset(&addr,0,sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path,argv[1],sizeof(addr.sun_path)-1);
+	if (fd==-1 || connect(fd,(struct sockaddr *)&addr,sizeof(addr))==-1)
+	{
+		printf("ERROR: cannot connect to server at %s. Exiting...\n",argv[1]);
+		return -1;
+	}
+	FILE *in = fdopen(fd,"r");
+	FILE *out = fdopen(dup(fd),"w");
+
+	clock_gettime(CLOCK_MONOTONIC,&t0);
+	while (getline(&line,&len,f) != -1) {
+		token = strtok(line,delim);
+		if (token==NULL)
+			continue;
+		fprintf(out,"%s %d %s %ld\n",token,maxlen,algo,lptimeout);
+		fflush(out);
+		if (getline(&reply,&replylen,in) == -1) {
+			printf("ERROR: server closed connection\n");
+			break;
+		}
+		fputs(reply,stdout);
+		numqueries++;
+		if (!strncmp(reply,"ERROR",5))
+			numerrors++;
+	}
+	clock_gettime(CLOCK_MONOTONIC,&t1);
+	fprintf(out,"quit\n");
+	fflush(out);
+
+	double elapsed = (t1.tv_sec-t0.tv_sec) + (t1.tv_nsec-t0.tv_nsec)*1e-9;
+	fprintf(stderr,"queries=%d, errors=%d, time=%f seconds, throughput=%f queries/second\n",
+		numqueries, numerrors, elapsed, (elapsed>0) ? numqueries/elapsed : 0.0);
+
+	fclose(in);
+	fclose(out);
+	fclose(f);
+	if (line)
+		free(line);
+	if (reply)
+		free(reply);
+	return 0;
+}
@@ -0,0 +1,149 @@
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "computeflow.h"
+#include "query.h"
+
+// query server: loads the graph once and answers flow queries until it is shut down
+// protocol: one request per line
+//   <vertex-id> [<maxlen> [<algorithm> [<lptimeout>]]]
+//                                            maxlen defaults to 4, algorithm to greedy (auto: chosen per DAG),
+//                                            lptimeout (seconds for an LP solve) to 0 (no limit)
+//   quit                                     closes the connection (stdin mode: stops the server)
+//   shutdown                                 stops the server
+// one reply line per request
+//   OK <vertex-id> <flow> <numnodes> <numedges> <totinter> <pathtime> <flowtime> <lower> <upper>
+//                                            lower<upper if the LP ran out of time (flow is then lower)
+//   ERROR <vertex-id> <message>
+
+#define DEFAULTPATHLEN 4
+
+static char *sockpath = NULL; // removed on exit
+
+static void cleanup(int sig)
+{
+	(void)sig;
+	if (sockpath != NULL)
+		unlink(sockpath);
+	_exit(0);
+}
+
+// answers requests read from in; returns 1 if the server should stop, 0 otherwise
+int serve(struct Graph *G, FILE *in, FILE *out, struct EdgeSet *es, struct PathScratch *ps, struct Arena *arena)
+{
+	char *line = NULL; // used for fileread
+	size_t len = 0; // used for fileread
+	const char delim[4] = " \t\n"; // used for fileread
+	char *token; // used for fileread
+	int stop = 0;
+	struct QueryResult res;
+	const char *errmsg;
+
+	while (getline(&line,&len,in) != -1) {
+		token = strtok(line,delim);
+		if (token==NULL)
+			continue;
+		if (!strcmp(token,"quit"))
+			break;
+		if (!strcmp(token,"shutdown")) {
+			stop = 1;
+			break;
+		}
+		char *end;
+		int source = (int)strtol(token,&end,10);
+		if (*end != '\0') {
+			fprintf(out,"ERROR %s invalid vertex-id\n",token);
+			fflush(out);
+			continue;
+		}
+		int maxlen = DEFAULTPATHLEN;
+		int algo = ALGO_GREEDY;
+		long lptimeout = 0;
+		if ((token = strtok(NULL,delim)) != NULL)
+			maxlen = atoi(token);
+		if ((token = strtok(NULL,delim)) != NULL)
+			algo = algo_from_name(token);
+		if ((token = strtok(NULL,delim)) != NULL)
+			lptimeout = atol(token);
+
+		if (runQuery(G, source, maxlen, algo, lptimeout, es, ps, arena, &res, &errmsg)==0)
+			fprintf(out,"OK %d %f %d %d %d %f %f %f %f\n",source,res.flow,res.numnodes,res.numedges,res.totinter,res.pathtime,res.flowtime,res.lower,res.upper);
+		else
+			fprintf(out,"ERROR %d %s\n",source,errmsg);
+		fflush(out);
+	}
+	if (line)
+		free(line);
+	return stop;
+}
+
+int main(int argc, char **argv)
+{
+	struct Graph G;
+	struct EdgeSet es; // edges of the current query's paths
+	struct PathScratch ps;
+	struct Arena arena; // memory of the current query's DAGs
+
+	if (argc != 2 && argc != 3)
+	{
+		printf("filename expected as argument (optionally followed by a unix socket path; default is stdin/stdout). Exiting...\n");
+		return -1;
+	}
+
+	if (load_graph(&G, argv[1], (int)sysconf(_SC_NPROCESSORS_ONLN))==-1)
+		return -1;
+	initEdgeSet(&es);
+	initPathScratch(&ps, G.numnodes);
+	initArena(&arena);
+
+	if (argc == 2) {
+		printf("READY\n");
+		fflush(stdout);
+		serve(&G, stdin, stdout, &es, &ps, &arena);
+	}
+	else {
+		struct sockaddr_un addr;
+		int sfd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (sfd==-1 || strlen(argv[2])>=sizeof(addr.sun_path))
+		{
+			printf("ERROR: cannot create socket %s. Exiting...\n",argv[2]);
+			return -1;
+		}
+		memset(&addr,0,sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		strcpy(addr.sun_path,argv[2]);
+		unlink(argv[2]); // stale socket of a previous run
+		if (bind(sfd,(struct sockaddr *)&addr,sizeof(addr))==-1 || listen(sfd,16)==-1)
+		{
+			printf("ERROR: cannot listen on socket %s. Exiting...\n",argv[2]);
+			return -1;
+		}
+		sockpath = argv[2];
+		signal(SIGINT, cleanup);
+		signal(SIGTERM, cleanup);
+		signal(SIGPIPE, SIG_IGN); // a client that disconnects must not stop the server
+		printf("READY: listening on %s\n",argv[2]);
+		fflush(stdout);
+
+		// clients are served one at a time; a connection may send any number of requests
+		int stop = 0;
+		while (!stop) {
+			int cfd = accept(sfd,NULL,NULL);
+			if (cfd==-1)
+				continue;
+			FILE *in = fdopen(cfd,"r");
+			FILE *out = fdopen(dup(cfd),"w");
+			stop = serve(&G, in, out, &es, &ps, &arena);
+			fclose(in);
+			fclose(out);
+		}
+		close(sfd);
+		unlink(argv[2]);
+	}
+
+	freeEdgeSet(&es);
+	freePathScratch(&ps);
+	freeArena(&arena);
+	freeGraph(&G);
+	return 0;
+}
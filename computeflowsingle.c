@@ -1,16 +1,20 @@
 #include "computeflow.h"
+#include "query.h"
+#include "maxflow.h"
+#include "bounds.h"
+#include "planner.h"
 
 int main(int argc, char **argv)
 {
 	int i,j,k;
-	FILE *f; // graph input file
 	struct Graph G;
 	//char fname[50];
 	
 	struct DAG *G2;
 	struct DAG *retDAG=NULL;
 	
-	struct Edge** edgearray;
+	struct EdgeSet es; // edges that exist in valid paths
+	struct PathScratch ps; // scratch space of findPaths2
 	int numedges;
 
     clock_t t;
@@ -18,23 +22,18 @@ int main(int argc, char **argv)
     
     double flow;
 	
-	edgearray = (struct Edge **)malloc(MAXEDGES*sizeof(struct Edge *)); //this array holds all edges that exist in valid paths 
+	initEdgeSet(&es);
 
 
-	if (argc != 3)
+	if (argc != 3 && argc != 4)
 	{
-		printf("filename and source-id expected as arguments. Exiting...\n");
+		printf("filename and source-id expected as arguments (optionally followed by number of loader threads). Exiting...\n");
 		return -1;
 	}
 	
-	f = fopen(argv[1],"r");
-	if (f==NULL)
-	{
-		printf("ERROR: file %s does not exist. Exiting...\n",argv[1]);
-		return -1;
-	}	
+	int numthreads = (argc == 4) ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN); // threads used to parse a text graph
 	
-    if (read_graph(&G, f)==-1)
+	if (load_graph(&G, argv[1], numthreads)==-1)
 		return -1;
 	
 	int source = atoi(argv[2]);   
@@ -42,9 +41,10 @@ int main(int argc, char **argv)
 	
 	// write paths from src to dest to a file
 	int pathlen = 4;
-	// write to edgearray distinct edges on paths from src to dest
-	//int totinter = findPaths2(G,source,sink,pathlen,edgearray,&numedges); 
-	int totinter = findPaths2(G,source,sink,pathlen,edgearray,&numedges); 
+	// collect in es the distinct edges on paths from src to dest
+	initPathScratch(&ps, G.numnodes);
+	int totinter = findPaths2(G,source,sink,pathlen,&es,&ps); 
+	numedges = es.numedges;
 	
 	printf("numedges=%d, totinter=%d\n",numedges, totinter);
 	
@@ -55,12 +55,12 @@ int main(int argc, char **argv)
 	
 	/*printf("num distinct edges in paths=%d\n",numedges);
 	for (i=0; i<numedges;i++) {
-		printf("%d %d\n",edgearray[i]->src,edgearray[i]->dest);
+		printf("%d %d\n",es.edge[i]->src,es.edge[i]->dest);
 	}*/
 	
-	//convert edgearray to DAG
+	//convert edge set to DAG
 	
-	G2 = edgearray2DAG(edgearray, numedges, sink, 1);
+	G2 = edgearray2DAG(es.edge, numedges, sink, 1, NULL);
 	printf("numnodes=%d\n",G2->numnodes);
 	//printDAG(G2);
 	//return -1;
@@ -84,6 +84,18 @@ int main(int argc, char **argv)
     printf("Computed flow: %f\n", flow);
     printf("Total time of execution: %f seconds\n", time_taken);
 
+	// flow bounds; if they meet, no LP is needed
+	struct FlowBounds b;
+	int decided = 0;
+	printf("Bounds are running \n");
+	t = clock();
+	if (computeFlowBounds(G2, &b)==0) {
+		decided = boundsDecided(&b);
+		printf("Flow bounds: lower=%f, upper=%f%s\n", b.lower, b.upper, decided ? " (LP skipped)" : "");
+	}
+	t = clock() - t;
+	time_taken = ((double)t)/CLOCKS_PER_SEC;
+	printf("Total time of execution: %f seconds\n", time_taken);
 
 /*
 	printf("Greedy With Inter is running \n");
@@ -101,7 +113,7 @@ int main(int argc, char **argv)
     }
 */
     
-    if (totinter<10000) {
+    if (!decided && totinter<MAXLPINTER) {
 		printf("LP is running \n");
 		t = clock();    
 		flow=computeFlowLP(*G2);
@@ -125,6 +137,29 @@ int main(int argc, char **argv)
 		if (inter != NULL) free(inter);
 		*/
     }
+
+	// exact flow without LP size limit
+	printf("Maxflow is running \n");
+	t = clock();
+	flow=computeFlowMaxflow(*G2);
+	t = clock() - t;
+	time_taken = ((double)t)/CLOCKS_PER_SEC;
+	printf("Computed flow: %f\n", flow);
+	printf("Total time of execution: %f seconds\n", time_taken);
+
+	// exact flow with the algorithm chosen by the cost model (on its own DAG, as it may preprocess it)
+	struct DAG *G3 = edgearray2DAG(es.edge, numedges, sink, 0, NULL);
+	struct CostModel cm;
+	struct FlowPlan p;
+	initCostModel(&cm);
+	printf("Planner is running \n");
+	if (planFlow(G3, &cm, &p)==0) {
+		printf("Chosen plan: %s (predicted %f seconds, statistics %f seconds)\n", plan_name(p.plan), p.predicted[p.plan], p.statstime);
+		printf("Computed flow: %f\n", p.flow);
+		printf("Total time of execution: %f seconds\n", p.actual);
+	}
+	freeDAG(G3);
+
 /*
    	printf("Recursive Greedy is running \n");
    	t = clock();    
@@ -181,11 +216,11 @@ int main(int argc, char **argv)
 		{
 			printf("DAG has no flow: sink disconnected\n");
 		}
-		else if (totinter-numdeletedinter<10000) {
+		else if (!decided && totinter-numdeletedinter<MAXLPINTER) {
 			writeDAGtofile(retDAG, "retDAG.txt");
 			printf("LP after pre is running \n");
 			t = clock();    
-			flow=computeFlowLP(*retDAG);
+			flow=computeFlowLPShared(*retDAG); // preprocessing keeps the max flow, not the flow of computeFlowLP
 			printf("Computed flow: %f\n", flow);
 			t = clock() - t;
 			time_taken = ((double)t)/CLOCKS_PER_SEC;
@@ -212,7 +247,9 @@ int main(int argc, char **argv)
         if (G2 != NULL) freeDAG(G2);
 	    if (retDAG != NULL) freeDAG(retDAG);
     }
-	free(edgearray);
+	freeEdgeSet(&es);
+	freePathScratch(&ps);
+	freeGraph(&G);
 	
    // printf("\n The Total Number of instances %s  = %d",  totalinstances);
     return 0;
@@ -0,0 +1,32 @@
+#include "computeflow.h"
+#include "graphbin.h"
+
+// converts a graph file in text format (see read_graph) to the binary format of graphbin.h
+int main(int argc, char **argv)
+{
+	FILE *f; // graph input file
+	struct Graph G;
+
+	if (argc != 3)
+	{
+		printf("text graph filename and binary graph filename expected as arguments. Exiting...\n");
+		return -1;
+	}
+
+	f = fopen(argv[1],"r");
+	if (f==NULL)
+	{
+		printf("ERROR: file %s does not exist. Exiting...\n",argv[1]);
+		return -1;
+	}
+
+	if (read_graph(&G, f)==-1)
+		return -1;
+
+	if (write_graph_bin(&G, argv[2])==-1)
+		return -1;
+	printf("binary graph written to %s\n",argv[2]);
+
+	freeGraph(&G);
+	return 0;
+}
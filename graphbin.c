@@ -0,0 +1,187 @@
+/*reading and writing graphs in binary (memory-mapped) format*/
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "graphbin.h"
+
+// returns 1 if filename is a binary graph file, 0 otherwise
+int is_graph_bin(char *filename)
+{
+	char magic[8];
+	FILE *f = fopen(filename,"rb");
+	if (f==NULL)
+		return 0;
+	int ret = (fread(magic,1,8,f)==8 && !memcmp(magic,GRAPHBIN_MAGIC,8));
+	fclose(f);
+	return ret;
+}
+
+// writes graph G to filename in binary format; returns 0 on success, -1 on error
+int write_graph_bin(struct Graph *G, char *filename)
+{
+	int i,j;
+	struct GraphBinHeader h;
+	struct GraphBinEdge be;
+	long long off;
+
+	FILE *f = fopen(filename,"wb");
+	if (f==NULL)
+	{
+		printf("ERROR: cannot open %s for writing\n",filename);
+		return -1;
+	}
+
+	memset(&h,0,sizeof(h));
+	memcpy(h.magic,GRAPHBIN_MAGIC,8);
+	h.version = GRAPHBIN_VERSION;
+	h.numnodes = G->numnodes;
+	for (i=0;i<G->numnodes;i++) {
+		h.numedges += G->node[i].numout;
+		for (j=0;j<G->node[i].numout;j++)
+			h.numinter += G->node[i].edge[j].numinter;
+	}
+	h.nodeoff = sizeof(struct GraphBinHeader);
+	h.edgeoff = h.nodeoff + (G->numnodes+1)*sizeof(long long);
+	h.summaryoff = h.edgeoff + h.numedges*sizeof(struct GraphBinEdge);
+	h.interoff = h.summaryoff + h.numedges*sizeof(struct EdgeSummary);
+	fwrite(&h,sizeof(h),1,f);
+
+	// node offsets
+	off = 0;
+	for (i=0;i<G->numnodes;i++) {
+		fwrite(&off,sizeof(long long),1,f);
+		off += G->node[i].numout;
+	}
+	fwrite(&off,sizeof(long long),1,f);
+
+	// edge records
+	off = 0;
+	memset(&be,0,sizeof(be));
+	for (i=0;i<G->numnodes;i++)
+		for (j=0;j<G->node[i].numout;j++) {
+			be.src = G->node[i].edge[j].src;
+			be.dest = G->node[i].edge[j].dest;
+			be.numinter = G->node[i].edge[j].numinter;
+			be.interidx = off;
+			fwrite(&be,sizeof(be),1,f);
+			off += be.numinter;
+		}
+
+	// edge summaries
+	for (i=0;i<G->numnodes;i++)
+		for (j=0;j<G->node[i].numout;j++)
+			fwrite(&G->summary[&G->node[i].edge[j]-G->edges],sizeof(struct EdgeSummary),1,f);
+
+	// interactions
+	for (i=0;i<G->numnodes;i++)
+		for (j=0;j<G->node[i].numout;j++)
+			fwrite(G->node[i].edge[j].inter,sizeof(struct Interaction),G->node[i].edge[j].numinter,f);
+
+	if (fclose(f)!=0)
+	{
+		printf("ERROR: failed writing %s\n",filename);
+		return -1;
+	}
+	return 0;
+}
+
+// memory-maps binary graph file filename into G; returns 0 on success, -1 on error
+// the only allocations are the node array and one contiguous edge pool;
+// interactions are used in place, so loading cost is proportional to nodes+edges, not to file size
+int read_graph_bin(struct Graph *G, char *filename)
+{
+	int i;
+	long long e;
+	struct stat st;
+	struct GraphBinHeader *h;
+
+	int fd = open(filename,O_RDONLY);
+	if (fd==-1)
+	{
+		printf("ERROR: file %s does not exist. Exiting...\n",filename);
+		return -1;
+	}
+	if (fstat(fd,&st)==-1 || st.st_size<(off_t)sizeof(struct GraphBinHeader))
+	{
+		printf("ERROR: file %s is not a binary graph file. Exiting...\n",filename);
+		close(fd);
+		return -1;
+	}
+	void *addr = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+	close(fd); // mapping stays valid after close
+	if (addr==MAP_FAILED)
+	{
+		printf("ERROR: cannot map file %s. Exiting...\n",filename);
+		return -1;
+	}
+
+	h = (struct GraphBinHeader *)addr;
+	if (memcmp(h->magic,GRAPHBIN_MAGIC,8) || h->version!=GRAPHBIN_VERSION
+		|| h->numnodes<0 || h->numedges<0 || h->numinter<0
+		|| h->nodeoff<0 || h->edgeoff<0 || h->summaryoff<0 || h->interoff<0
+		|| h->nodeoff+(h->numnodes+1LL)*(long long)sizeof(long long) > (long long)st.st_size
+		|| h->edgeoff+h->numedges*(long long)sizeof(struct GraphBinEdge) > (long long)st.st_size
+		|| h->summaryoff+h->numedges*(long long)sizeof(struct EdgeSummary) > (long long)st.st_size
+		|| h->interoff+h->numinter*(long long)sizeof(struct Interaction) > (long long)st.st_size)
+	{
+		printf("ERROR: file %s has wrong format or version (convert it again with convertgraph). Exiting...\n",filename);
+		munmap(addr,st.st_size);
+		return -1;
+	}
+
+	long long *nodeoff = (long long *)((char *)addr + h->nodeoff);
+	struct GraphBinEdge *be = (struct GraphBinEdge *)((char *)addr + h->edgeoff);
+	struct Interaction *inter = (struct Interaction *)((char *)addr + h->interoff);
+
+	// interactions are accessed edge by edge, following the paths being explored
+	madvise((char *)addr + h->interoff, h->numinter*sizeof(struct Interaction), MADV_RANDOM);
+
+	G->numnodes = h->numnodes;
+	G->numedges = h->numedges;
+	G->numinter = h->numinter;
+	G->inter = inter;
+	G->mapaddr = addr;
+	G->maplen = st.st_size;
+	G->node = (struct Node*)malloc(G->numnodes*sizeof(struct Node));
+	G->edges = (struct Edge*)malloc(h->numedges*sizeof(struct Edge));
+
+	// the records are checked as they are read, so that a corrupt file cannot make
+	// the graph point outside the mapping
+	int bad = 0;
+	for (e=0;e<h->numedges && !bad;e++) {
+		bad = be[e].src<0 || be[e].src>=h->numnodes || be[e].dest<0 || be[e].dest>=h->numnodes
+			|| be[e].numinter<0 || be[e].interidx<0 || be[e].interidx+be[e].numinter>h->numinter;
+		G->edges[e].src = be[e].src;
+		G->edges[e].dest = be[e].dest;
+		G->edges[e].numinter = be[e].numinter;
+		G->edges[e].owninter = 0;
+		G->edges[e].inter = inter + be[e].interidx;
+	}
+	G->summary = (struct EdgeSummary *)((char *)addr + h->summaryoff);
+	for (i=0;i<G->numnodes && !bad;i++) {
+		bad = nodeoff[i]<0 || nodeoff[i+1]<nodeoff[i] || nodeoff[i+1]>h->numedges;
+		G->node[i].label = i;
+		G->node[i].numout = (int)(nodeoff[i+1]-nodeoff[i]);
+		G->node[i].edge = (G->node[i].numout>0) ? G->edges + nodeoff[i] : NULL;
+	}
+	if (bad)
+	{
+		printf("ERROR: file %s has wrong format or version (convert it again with convertgraph). Exiting...\n",filename);
+		free(G->node);
+		free(G->edges);
+		G->node = NULL;
+		G->edges = NULL;
+		G->summary = NULL;
+		G->inter = NULL;
+		G->mapaddr = NULL;
+		munmap(addr,st.st_size);
+		return -1;
+	}
+
+	indexIncomingEdges(G);
+
+	printf("numnodes=%d\n",G->numnodes);
+	printf("numedges=%lld\n",h->numedges);
+	printf("numinteractions=%lld\n",h->numinter);
+
+	return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef __GRAPHBIN
+#define __GRAPHBIN
+
+#include "computeflow.h"
+
+/* binary graph file format, produced by convertgraph and memory-mapped by read_graph_bin */
+/* all sections are 8-byte aligned and stored in native byte order: */
+/*   struct GraphBinHeader */
+/*   long long nodeoff[numnodes+1]     edges of node i are edge records nodeoff[i]..nodeoff[i+1]-1 */
+/*   struct GraphBinEdge edge[numedges] */
+/*   struct EdgeSummary summary[numedges] interaction summaries of the edges, in edge order */
+/*   struct Interaction inter[numinter] interactions of all edges, edge after edge, sorted by time per edge */
+/* interactions are stored with the layout of struct Interaction, so that */
+/* struct Edge.inter can point straight into the mapped file (no per-edge copies); */
+/* likewise, struct Graph.summary points to the summaries section */
+
+#define GRAPHBIN_MAGIC "TINGRAPH"
+#define GRAPHBIN_VERSION 2
+
+struct GraphBinHeader {
+	char magic[8]; // GRAPHBIN_MAGIC (not null-terminated)
+	int version; // GRAPHBIN_VERSION
+	int numnodes;
+	long long numedges;
+	long long numinter;
+	long long nodeoff; // file offset of node offsets array
+	long long edgeoff; // file offset of edge records
+	long long interoff; // file offset of interactions
+	long long summaryoff; // file offset of edge summaries
+};
+
+struct GraphBinEdge {
+	int src;
+	int dest;
+	int numinter;
+	int pad; // keeps interidx 8-byte aligned
+	long long interidx; // position of first interaction of edge in the interactions section
+};
+
+// returns 1 if filename is a binary graph file, 0 otherwise
+int is_graph_bin(char *filename);
+
+// writes graph G to filename in binary format; returns 0 on success, -1 on error
+int write_graph_bin(struct Graph *G, char *filename);
+
+// memory-maps binary graph file filename into G; returns 0 on success, -1 on error
+// interactions are not copied: edges point into the mapped region, which is released by freeGraph
+int read_graph_bin(struct Graph *G, char *filename);
+
+#endif // __GRAPHBIN
@@ -0,0 +1,353 @@
+/*multi-threaded reader for graph files in text format*/
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "graphpar.h"
+
+// exact powers of 10 used by parse_double; doubles represent 10^0..10^22 exactly
+static const double pow10tab[23] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+	1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+// work of one thread: nodes whose header line starts in [start,end)
+struct ParseChunk {
+	struct Graph *G;
+	const char *data; // whole file
+	size_t size;
+	size_t start;
+	size_t end;
+	long long numedges; // number of edges and interactions in chunk (counting pass)
+	long long numinter;
+	long long edgebase; // position of chunk's first edge/interaction in the graph pools
+	long long interbase;
+	double totalflow;
+	int error; // set to 1 if the chunk could not be parsed
+};
+
+// skips field separators (tabs, spaces) but not line ends
+static inline size_t skip_sep(const char *s, size_t pos, size_t size)
+{
+	while (pos<size && (s[pos]=='\t' || s[pos]==' '))
+		pos++;
+	return pos;
+}
+
+// parses a non-negative integer at s[*pos]; returns -1 if there is no number
+static inline int parse_int(const char *s, size_t *pos, size_t size)
+{
+	size_t p = skip_sep(s,*pos,size);
+	int v = 0;
+	if (p>=size || s[p]<'0' || s[p]>'9')
+		return -1;
+	while (p<size && s[p]>='0' && s[p]<='9')
+		v = v*10 + (s[p++]-'0');
+	*pos = p;
+	return v;
+}
+
+// parses a decimal number at s[*pos]
+// mantissas up to 2^53 with small exponents are converted exactly (same result as atof),
+// anything else falls back to strtod
+static inline double parse_double(const char *s, size_t *pos, size_t size)
+{
+	size_t p = skip_sep(s,*pos,size);
+	size_t begin = p;
+	int neg = 0;
+	unsigned long long mant = 0;
+	int digits = 0;
+	int exp10 = 0;
+
+	if (p<size && (s[p]=='-' || s[p]=='+'))
+		neg = (s[p++]=='-');
+	while (p<size && s[p]>='0' && s[p]<='9') {
+		if (digits<19) { mant = mant*10 + (s[p]-'0'); if (mant) digits++; }
+		else exp10++;
+		p++;
+	}
+	if (p<size && s[p]=='.') {
+		p++;
+		while (p<size && s[p]>='0' && s[p]<='9') {
+			if (digits<19) { mant = mant*10 + (s[p]-'0'); if (mant) digits++; exp10--; }
+			p++;
+		}
+	}
+	if ((p<size && (s[p]=='e' || s[p]=='E')) || mant>(1ULL<<53) || exp10<-22 || exp10>22) {
+		// rare case: let the C library do the rounding
+		char buf[64];
+		size_t n = 0;
+		p = begin;
+		while (p<size && n<sizeof(buf)-1 && s[p]!='\t' && s[p]!=' ' && s[p]!='\n' && s[p]!='\r')
+			buf[n++] = s[p++];
+		buf[n] = 0;
+		*pos = p;
+		return strtod(buf,NULL);
+	}
+	*pos = p;
+	double v = (double)mant;
+	v = (exp10<0) ? v/pow10tab[-exp10] : v*pow10tab[exp10];
+	return neg ? -v : v;
+}
+
+// moves pos to the beginning of the next line
+static inline size_t next_line(const char *s, size_t pos, size_t size)
+{
+	while (pos<size && s[pos]!='\n')
+		pos++;
+	return (pos<size) ? pos+1 : size;
+}
+
+// returns 1 if the line starting at pos is a node header line (exactly two numbers)
+static int is_header(const char *s, size_t pos, size_t size)
+{
+	int numtokens = 0;
+	while (pos<size && s[pos]!='\n') {
+		pos = skip_sep(s,pos,size);
+		if (pos>=size || s[pos]=='\n' || s[pos]=='\r')
+			break;
+		numtokens++;
+		if (numtokens>2)
+			return 0;
+		while (pos<size && s[pos]!='\t' && s[pos]!=' ' && s[pos]!='\n')
+			pos++;
+	}
+	return numtokens==2;
+}
+
+// counting pass: finds the number of edges and interactions of the chunk
+// only the leading integers of each line are parsed, interactions are skipped
+static void *count_chunk(void *arg)
+{
+	struct ParseChunk *c = (struct ParseChunk *)arg;
+	const char *s = c->data;
+	size_t size = c->size;
+	size_t pos = c->start;
+	int j;
+
+	while (pos<c->end) {
+		parse_int(s,&pos,size); // src
+		int numout = parse_int(s,&pos,size);
+		if (numout<0) {
+			printf("Problem in node header at byte %zu\n",pos);
+			c->error = 1;
+			return NULL;
+		}
+		pos = next_line(s,pos,size);
+		c->numedges += numout;
+		for (j=0;j<numout;j++) {
+			parse_int(s,&pos,size); // src
+			parse_int(s,&pos,size); // dest
+			int numinter = parse_int(s,&pos,size);
+			if (numinter<0) {
+				printf("Problem in edge line at byte %zu\n",pos);
+				c->error = 1;
+				return NULL;
+			}
+			c->numinter += numinter;
+			const char *eol = memchr(s+pos,'\n',size-pos);
+			pos = (eol!=NULL) ? (size_t)(eol-s)+1 : size;
+		}
+	}
+	return NULL;
+}
+
+// parsing pass: fills the graph pools from position c->edgebase/c->interbase on
+static void *parse_chunk(void *arg)
+{
+	struct ParseChunk *c = (struct ParseChunk *)arg;
+	struct Graph *G = c->G;
+	const char *s = c->data;
+	size_t size = c->size;
+	size_t pos = c->start;
+	struct Edge *e = G->edges + c->edgebase;
+	struct Interaction *inter = G->inter + c->interbase;
+	int j,k;
+
+	while (pos<c->end) {
+		// next line to be read should be <src> <outdegree>
+		int src = parse_int(s,&pos,size);
+		int numout = parse_int(s,&pos,size);
+		if (src<0 || src>=G->numnodes) {
+			printf("Problem in node header at byte %zu\n",pos);
+			c->error = 1;
+			return NULL;
+		}
+		pos = next_line(s,pos,size);
+
+		G->node[src].label = src;
+		G->node[src].numout = numout;
+		G->node[src].edge = (numout>0) ? e : NULL;
+		for (j=0;j<numout;j++,e++) {
+			e->src = parse_int(s,&pos,size);
+			if (e->src != src) {
+				printf("Problem in edge line at byte %zu: %d %d\n",pos,src,e->src);
+				c->error = 1;
+				return NULL;
+			}
+			e->dest = parse_int(s,&pos,size);
+			e->numinter = parse_int(s,&pos,size);
+			if (e->dest<0 || e->dest>=G->numnodes) {
+				printf("Problem in edge line at byte %zu\n",pos);
+				c->error = 1;
+				return NULL;
+			}
+			e->owninter = 0;
+			e->inter = inter;
+			for(k=0;k<e->numinter;k++) {
+				inter[k].timestamp = parse_double(s,&pos,size);
+				inter[k].quantity = parse_double(s,&pos,size);
+				c->totalflow += inter[k].quantity;
+			}
+			summarizeEdge(e, &G->summary[e-G->edges]);
+			inter += e->numinter;
+			pos = next_line(s,pos,size);
+		}
+	}
+	return NULL;
+}
+
+// reads a graph file in text format (see read_graph) using numthreads threads
+// the file is split into byte ranges which are re-synchronized on node header lines
+// (<node> <outdegree>); each thread parses the nodes whose header starts in its range
+// returns 0 on success, -1 on error
+int read_graph_parallel(struct Graph *G, char *filename, int numthreads)
+{
+	int i,t;
+	struct stat st;
+	size_t pos = 0;
+	int ret = 0;
+
+	int fd = open(filename,O_RDONLY);
+	if (fd==-1)
+	{
+		printf("ERROR: file %s does not exist. Exiting...\n",filename);
+		return -1;
+	}
+	if (fstat(fd,&st)==-1 || st.st_size==0)
+	{
+		printf("ERROR: first line is empty. Exiting...\n");
+		close(fd);
+		return -1;
+	}
+	size_t size = st.st_size;
+	const char *data = (const char *)mmap(NULL,size,PROT_READ,MAP_PRIVATE,fd,0);
+	close(fd);
+	if (data==MAP_FAILED)
+	{
+		printf("ERROR: cannot map file %s. Exiting...\n",filename);
+		return -1;
+	}
+	madvise((void *)data,size,MADV_SEQUENTIAL);
+
+	/* first line should be <numnodes> */
+	G->numnodes = parse_int(data,&pos,size);
+	if (G->numnodes<0)
+	{
+		printf("ERROR: first line is empty. Exiting...\n");
+		munmap((void *)data,size);
+		return -1;
+	}
+	pos = next_line(data,pos,size);
+
+	// Initialize data structure
+	G->node = (struct Node*)malloc(G->numnodes*sizeof(struct Node));
+	for (i=0;i<G->numnodes;i++) {
+		G->node[i].label = -1;
+		G->node[i].numout = 0;
+		G->node[i].edge = NULL;
+	}
+	G->mapaddr = NULL;
+	G->maplen = 0;
+
+	// split file into ranges that start at node header lines
+	if (numthreads<1)
+		numthreads = 1;
+	struct ParseChunk *chunk = (struct ParseChunk *)calloc(numthreads,sizeof(struct ParseChunk));
+	pthread_t *tid = (pthread_t *)malloc(numthreads*sizeof(pthread_t));
+	for (t=0;t<numthreads;t++) {
+		size_t start = pos + (size-pos)/numthreads*t;
+		if (t>0) {
+			if (start<chunk[t-1].start)
+				start = chunk[t-1].start;
+			if (start>pos && data[start-1]!='\n')
+				start = next_line(data,start,size);
+			while (start<size && !is_header(data,start,size))
+				start = next_line(data,start,size);
+		}
+		chunk[t].G = G;
+		chunk[t].data = data;
+		chunk[t].size = size;
+		chunk[t].start = (t==0) ? pos : start;
+	}
+	for (t=0;t<numthreads;t++)
+		chunk[t].end = (t<numthreads-1) ? chunk[t+1].start : size;
+
+	// pass 1: count edges and interactions per chunk, so that every chunk knows
+	// where its edges and interactions go in the graph pools
+	for (t=1;t<numthreads;t++)
+		pthread_create(&tid[t],NULL,count_chunk,&chunk[t]);
+	count_chunk(&chunk[0]);
+	for (t=1;t<numthreads;t++)
+		pthread_join(tid[t],NULL);
+
+	G->numedges = 0;
+	G->numinter = 0;
+	for (t=0;t<numthreads;t++) {
+		if (chunk[t].error)
+			ret = -1;
+		chunk[t].edgebase = G->numedges;
+		chunk[t].interbase = G->numinter;
+		G->numedges += chunk[t].numedges;
+		G->numinter += chunk[t].numinter;
+	}
+	G->edges = (struct Edge*)malloc(G->numedges*sizeof(struct Edge));
+	G->inter = (struct Interaction*)malloc(G->numinter*sizeof(struct Interaction));
+	G->summary = (struct EdgeSummary*)malloc((G->numedges+1)*sizeof(struct EdgeSummary));
+
+	// pass 2: parse chunks into the pools
+	if (ret==0) {
+		for (t=1;t<numthreads;t++)
+			pthread_create(&tid[t],NULL,parse_chunk,&chunk[t]);
+		parse_chunk(&chunk[0]);
+		for (t=1;t<numthreads;t++)
+			pthread_join(tid[t],NULL);
+	}
+
+	double totalflow=0;
+	for (t=0;t<numthreads;t++) {
+		if (chunk[t].error)
+			ret = -1;
+		totalflow += chunk[t].totalflow;
+	}
+	free(chunk);
+	free(tid);
+	munmap((void *)data,size);
+	if (ret==-1) {
+		// the caller may survive a failed load, so the graph is left empty
+		free(G->node);
+		free(G->edges);
+		free(G->inter);
+		free(G->summary);
+		G->node = NULL;
+		G->edges = NULL;
+		G->inter = NULL;
+		G->summary = NULL;
+		return -1;
+	}
+
+	// handle "phantom" nodes (see read_graph); destinations count as seen nodes
+	for (long long e=0;e<G->numedges;e++)
+		G->node[G->edges[e].dest].label = G->edges[e].dest;
+	int cphantoms=0;
+	for (i=0;i<G->numnodes;i++)
+		if (G->node[i].label!=i) {
+			cphantoms++;
+			G->node[i].label = i;
+		}
+	indexIncomingEdges(G);
+
+	printf("numnodes=%d\n",G->numnodes);
+	printf("numedges=%lld\n",G->numedges);
+	printf("numinteractions=%lld\n",G->numinter);
+	printf("average flow per interaction=%f\n",totalflow/G->numinter);
+	printf("numphantoms = %d\n",cphantoms);
+
+	return 0;
+}
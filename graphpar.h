@@ -0,0 +1,13 @@
+#ifndef __GRAPHPAR
+#define __GRAPHPAR
+
+#include <pthread.h>
+#include "computeflow.h"
+
+// reads a graph file in text format (see read_graph) using numthreads threads
+// the file is split into byte ranges which are re-synchronized on node header lines
+// (<node> <outdegree>); each thread parses the nodes whose header starts in its range
+// returns 0 on success, -1 on error
+int read_graph_parallel(struct Graph *G, char *filename, int numthreads);
+
+#endif // __GRAPHPAR
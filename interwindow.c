@@ -0,0 +1,99 @@
+/*time-window scans over the interactions of an edge (see interwindow.h)*/
+#include "interwindow.h"
+
+#define SUMLANES 8 // partial sums of both kernels: interaction k is added to partial sum k%SUMLANES
+
+int searchWindow(const struct Interaction *inter, int numinter, double t, int strict)
+{
+	int lo = 0;
+	int hi = numinter;
+	while (lo < hi) {
+		int mid = lo + (hi-lo)/2;
+		if (inter[mid].timestamp < t || (strict && inter[mid].timestamp == t))
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static double sumQuantitiesScalar(const struct Interaction *inter, int numinter)
+{
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, s5 = 0, s6 = 0, s7 = 0;
+	int k = 0;
+
+	for (; k+SUMLANES<=numinter; k+=SUMLANES) {
+		s0 += inter[k].quantity;
+		s1 += inter[k+1].quantity;
+		s2 += inter[k+2].quantity;
+		s3 += inter[k+3].quantity;
+		s4 += inter[k+4].quantity;
+		s5 += inter[k+5].quantity;
+		s6 += inter[k+6].quantity;
+		s7 += inter[k+7].quantity;
+	}
+	// same order as the horizontal reduction of the AVX2 kernel
+	double sum = ((s0+s2)+(s4+s6)) + ((s1+s3)+(s5+s7));
+	for (; k<numinter; k++)
+		sum += inter[k].quantity;
+	return sum;
+}
+
+static double (*sumkernel)(const struct Interaction *, int) = sumQuantitiesScalar;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+// a 256-bit load covers two interactions {t0,q0,t1,q1}; lanes 1 and 3 of the four accumulators
+// hold partial sums 0..7 of the scalar kernel, the timestamps summed in lanes 0 and 2 are ignored
+__attribute__((target("avx2")))
+static double sumQuantitiesAVX2(const struct Interaction *inter, int numinter)
+{
+	const double *p = (const double *)inter;
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	__m256d acc2 = _mm256_setzero_pd();
+	__m256d acc3 = _mm256_setzero_pd();
+	double s[4];
+	int k = 0;
+
+	for (; k+SUMLANES<=numinter; k+=SUMLANES, p+=2*SUMLANES) {
+		acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(p));
+		acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(p+4));
+		acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(p+8));
+		acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(p+12));
+	}
+	// ((s0+s2)+(s4+s6)) in lane 1 and ((s1+s3)+(s5+s7)) in lane 3, as in the scalar kernel
+	_mm256_storeu_pd(s, _mm256_add_pd(_mm256_add_pd(acc0,acc1), _mm256_add_pd(acc2,acc3)));
+	double sum = s[1]+s[3];
+	for (; k<numinter; k++)
+		sum += inter[k].quantity;
+	_mm256_zeroupper(); // not emitted by the compiler at -O; avoids AVX-SSE transition stalls in the caller
+	return sum;
+}
+
+// picks the kernel of sumQuantities before main runs, so worker threads only read sumkernel
+__attribute__((constructor))
+static void selectSumKernel(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		sumkernel = sumQuantitiesAVX2;
+}
+#endif
+
+double sumQuantities(const struct Interaction *inter, int numinter)
+{
+	return sumkernel(inter, numinter);
+}
+
+int windowInteractions(const struct Interaction *inter, int numinter, double lo, double hi, int *first, double *qty)
+{
+	int begin = searchWindow(inter, numinter, lo, 1);
+	int end = begin + searchWindow(inter+begin, numinter-begin, hi, 0);
+
+	*first = begin;
+	if (qty != NULL)
+		*qty = sumQuantities(inter+begin, end-begin);
+	return end-begin;
+}
@@ -0,0 +1,22 @@
+#ifndef __INTERWINDOW
+#define __INTERWINDOW
+
+#include "computeflow.h"
+
+/* time-window scans over the interactions of an edge (sorted by time, stored as {timestamp,quantity} pairs) */
+/* a window is a contiguous range found by binary search, so only the total quantity of the range is a scan; */
+/* it is summed by an AVX2 kernel if the CPU supports it (checked once at startup) and else by a scalar */
+/* kernel that adds in the same order, so both give bit-identical results */
+
+// returns the first position k of inter[0..numinter-1] with timestamp > t (strict=1) or timestamp >= t (strict=0)
+// (numinter if there is none), i.e. the number of interactions before that time
+int searchWindow(const struct Interaction *inter, int numinter, double t, int strict);
+
+// returns the number of interactions inter[0..numinter-1] with lo < timestamp < hi; they are
+// inter[*first..*first+count-1]; if qty is not NULL, their total quantity is stored in *qty
+int windowInteractions(const struct Interaction *inter, int numinter, double lo, double hi, int *first, double *qty);
+
+// returns the total quantity of interactions inter[0..numinter-1]
+double sumQuantities(const struct Interaction *inter, int numinter);
+
+#endif // __INTERWINDOW
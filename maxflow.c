@@ -0,0 +1,271 @@
+/*flow computation as max-flow (Dinic) on the time-expanded network of a DAG*/
+#include "maxflow.h"
+#include "interwindow.h"
+
+#define MFEPS 1e-9 // residual capacities below MFEPS count as saturated
+
+//compare two timestamps; used by qsort call in function buildNetwork
+static int compTime(const void *a, const void *b) {
+	if (*(double *)a > *(double *)b)
+    	return 1;
+  	else if (*(double *)a < *(double *)b)
+    	return -1;
+  	else
+    	return 0;
+}
+
+// first index in times[lo..hi-1] (sorted) with times[k] > t (strict=1) or times[k] >= t (strict=0)
+static int searchtime(double *times, int lo, int hi, double t, int strict)
+{
+	while (lo < hi) {
+		int mid = lo + (hi-lo)/2;
+		if (times[mid] < t || (strict && times[mid] == t))
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+// builds the time-expanded network of DAG G (see maxflow.h); its arrays are allocated with dagalloc
+// vertex tstart[u]+k is node u at its k-th distinct departure time
+// if sinkarc is not NULL, the arcs into the super-sink and their timestamps are stored in
+// sinkarc/sinktime (arrays of totinter elements) and counted in numsinkarcs
+static void buildNetwork(struct DAG *G, struct MFNetwork *N, int *sinkarc, double *sinktime, int *numsinkarcs)
+{
+	int i,j,k;
+	int sink = G->numnodes-1;
+	int totinter = 0;
+	double totqty = 0;
+
+	// distinct departure times per node; the source and the sink get no vertices
+	int *tstart = (int *)dagalloc(G, (G->numnodes+1)*sizeof(int));
+	memset(tstart,0,(G->numnodes+1)*sizeof(int));
+	for (i=0; i<G->numedges; i++) {
+		totinter += G->edgearray[i]->numinter;
+		if (G->edgearray[i]->src != 0)
+			tstart[G->edgearray[i]->src+1] += G->edgearray[i]->numinter;
+		totqty += sumQuantities(G->edgearray[i]->inter, G->edgearray[i]->numinter);
+	}
+	for (i=0; i<G->numnodes; i++)
+		tstart[i+1] += tstart[i];
+	double *times = (double *)dagalloc(G, (tstart[G->numnodes]+1)*sizeof(double));
+	int *fill = (int *)dagalloc(G, (G->numnodes+1)*sizeof(int));
+	memcpy(fill,tstart,G->numnodes*sizeof(int));
+	for (i=0; i<G->numedges; i++)
+		if (G->edgearray[i]->src != 0)
+			for (j=0; j<G->edgearray[i]->numinter; j++)
+				times[fill[G->edgearray[i]->src]++] = G->edgearray[i]->inter[j].timestamp;
+	int numtimes = 0; // sort per node and remove duplicates, compacting the pool
+	for (i=0; i<G->numnodes; i++) {
+		int begin = tstart[i];
+		int end = tstart[i+1];
+		qsort(times+begin, end-begin, sizeof(double), compTime);
+		tstart[i] = numtimes;
+		for (k=begin; k<end; k++)
+			if (k==begin || times[k] != times[k-1])
+				times[numtimes++] = times[k];
+	}
+	tstart[G->numnodes] = numtimes;
+	dagfree(G, fill);
+
+	N->numvert = numtimes+2;
+	N->source = numtimes;
+	N->sink = numtimes+1;
+
+	// arcs: one per usable interaction plus holdover arcs; every arc is followed by its reverse
+	int maxarcs = 2*(totinter+numtimes);
+	N->arc = (struct MFArc *)dagalloc(G, (maxarcs+1)*sizeof(struct MFArc));
+	N->numarcs = 0;
+	if (numsinkarcs != NULL)
+		*numsinkarcs = 0;
+	for (i=0; i<G->numedges; i++) {
+		int u = G->edgearray[i]->src;
+		int v = G->edgearray[i]->dest;
+		for (j=0; j<G->edgearray[i]->numinter; j++) {
+			double t = G->edgearray[i]->inter[j].timestamp;
+			int from = (u==0) ? N->source : searchtime(times,tstart[u],tstart[u+1],t,0);
+			int to;
+			if (v==sink)
+				to = N->sink;
+			else {
+				to = searchtime(times,tstart[v],tstart[v+1],t,1);
+				if (to==tstart[v+1]) // v has no later departure: interaction cannot carry flow to sink
+					continue;
+			}
+			if (to==N->sink && sinkarc != NULL) {
+				sinkarc[*numsinkarcs] = N->numarcs;
+				sinktime[(*numsinkarcs)++] = t;
+			}
+			N->arc[N->numarcs].to = to;
+			N->arc[N->numarcs++].cap = G->edgearray[i]->inter[j].quantity;
+			N->arc[N->numarcs].to = from;
+			N->arc[N->numarcs++].cap = 0;
+		}
+	}
+	for (i=1; i<sink; i++)
+		for (k=tstart[i]; k<tstart[i+1]-1; k++) { // holdover: buffered flow waits for a later departure
+			N->arc[N->numarcs].to = k+1;
+			N->arc[N->numarcs++].cap = totqty+1;
+			N->arc[N->numarcs].to = k;
+			N->arc[N->numarcs++].cap = 0;
+		}
+
+	// group arcs by tail vertex (tail of arc a is the head of its reverse arc a^1)
+	N->start = (int *)dagalloc(G, (N->numvert+1)*sizeof(int));
+	memset(N->start,0,(N->numvert+1)*sizeof(int));
+	N->adj = (int *)dagalloc(G, (N->numarcs+1)*sizeof(int));
+	for (i=0; i<N->numarcs; i++)
+		N->start[N->arc[i^1].to+1]++;
+	for (i=0; i<N->numvert; i++)
+		N->start[i+1] += N->start[i];
+	fill = (int *)dagalloc(G, N->numvert*sizeof(int));
+	memcpy(fill,N->start,N->numvert*sizeof(int));
+	for (i=0; i<N->numarcs; i++)
+		N->adj[fill[N->arc[i^1].to]++] = i;
+
+	dagfree(G, fill);
+	dagfree(G, tstart);
+	dagfree(G, times);
+}
+
+static void freeNetwork(struct DAG *G, struct MFNetwork *N)
+{
+	dagfree(G, N->start);
+	dagfree(G, N->adj);
+	dagfree(G, N->arc);
+}
+
+// breadth-first search on the residual network; returns 1 if the super-sink is reachable
+static int levelgraph(struct MFNetwork *N, int *level, int *queue)
+{
+	int head = 0;
+	int tail = 0;
+	for (int v=0; v<N->numvert; v++)
+		level[v] = -1;
+	level[N->source] = 0;
+	queue[tail++] = N->source;
+	while (head < tail) {
+		int v = queue[head++];
+		for (int k=N->start[v]; k<N->start[v+1]; k++) {
+			struct MFArc *a = &N->arc[N->adj[k]];
+			if (a->cap > MFEPS && level[a->to] == -1) {
+				level[a->to] = level[v]+1;
+				queue[tail++] = a->to;
+			}
+		}
+	}
+	return level[N->sink] != -1;
+}
+
+// finds a blocking flow in the level graph with an explicit path stack
+// it[v] is the next candidate position in v's arc list; returns the flow sent
+static double blockingflow(struct MFNetwork *N, int *level, int *it, int *path)
+{
+	double flow = 0;
+	int len = 0; // number of arcs on current path
+	int v = N->source;
+
+	memcpy(it,N->start,N->numvert*sizeof(int));
+	while (1) {
+		if (v == N->sink) { // augment along path by its bottleneck
+			double bottleneck = N->arc[path[0]].cap;
+			for (int k=1; k<len; k++)
+				if (N->arc[path[k]].cap < bottleneck)
+					bottleneck = N->arc[path[k]].cap;
+			int first = len; // first saturated arc on path
+			for (int k=0; k<len; k++) {
+				N->arc[path[k]].cap -= bottleneck;
+				N->arc[path[k]^1].cap += bottleneck;
+				if (first==len && N->arc[path[k]].cap <= MFEPS)
+					first = k;
+			}
+			flow += bottleneck;
+			len = first; // continue from the tail of the saturated arc
+			v = N->arc[path[first]^1].to;
+			continue;
+		}
+		// advance along an admissible arc
+		while (it[v] < N->start[v+1]) {
+			struct MFArc *a = &N->arc[N->adj[it[v]]];
+			if (a->cap > MFEPS && level[a->to] == level[v]+1)
+				break;
+			it[v]++;
+		}
+		if (it[v] < N->start[v+1]) {
+			path[len++] = N->adj[it[v]];
+			v = N->arc[N->adj[it[v]]].to;
+		}
+		else { // dead end: retreat
+			level[v] = -1;
+			if (len == 0)
+				break;
+			len--;
+			v = N->arc[path[len]^1].to;
+			it[v]++;
+		}
+	}
+	return flow;
+}
+
+// computes the flow of DAG G with Dinic's algorithm; if inter is not NULL, the interactions into
+// the sink carrying flow are returned in *inter (sorted by time) and counted in *numinter
+static double maxflowDAG(struct DAG G, struct Interaction **inter, int *numinter)
+{
+	struct MFNetwork N;
+	int *sinkarc = NULL;
+	double *sinktime = NULL;
+	int numsinkarcs = 0;
+	double flow = 0;
+
+	if (inter != NULL) {
+		int ti = 0;
+		for (int i=0; i<G.numedges; i++)
+			ti += G.edgearray[i]->numinter;
+		sinkarc = (int *)dagalloc(&G, (ti+1)*sizeof(int));
+		sinktime = (double *)dagalloc(&G, (ti+1)*sizeof(double));
+	}
+	buildNetwork(&G, &N, sinkarc, sinktime, (inter != NULL) ? &numsinkarcs : NULL);
+
+	int *level = (int *)dagalloc(&G, N.numvert*sizeof(int));
+	int *queue = (int *)dagalloc(&G, N.numvert*sizeof(int));
+	int *it = (int *)dagalloc(&G, N.numvert*sizeof(int));
+	int *path = (int *)dagalloc(&G, N.numvert*sizeof(int));
+	while (levelgraph(&N, level, queue))
+		flow += blockingflow(&N, level, it, path);
+
+	if (inter != NULL) {
+		*numinter = 0;
+		*inter = (struct Interaction *)malloc((numsinkarcs+1)*sizeof(struct Interaction));
+		for (int i=0; i<numsinkarcs; i++) {
+			double f = N.arc[sinkarc[i]^1].cap; // flow on arc = capacity of its reverse arc
+			if (f > MFEPS) {
+				(*inter)[*numinter].timestamp = sinktime[i];
+				(*inter)[(*numinter)++].quantity = f;
+			}
+		}
+		qsort((*inter), *numinter, sizeof(struct Interaction), compInter);
+		dagfree(&G, sinkarc);
+		dagfree(&G, sinktime);
+	}
+
+	dagfree(&G, level);
+	dagfree(&G, queue);
+	dagfree(&G, it);
+	dagfree(&G, path);
+	freeNetwork(&G, &N);
+	return flow;
+}
+
+// computes the flow throughout a DAG from its source (node at position 0)
+// to its sink (node at position G.numnodes-1) as a max-flow on the time-expanded network
+double computeFlowMaxflow(struct DAG G)
+{
+	return maxflowDAG(G, NULL, NULL);
+}
+
+// same as computeFlowMaxflow; returns incoming interactions to sink, which accumulate to total flow
+double computeFlowMaxflowWithInter(struct DAG G, struct Interaction **inter, int *numinter)
+{
+	return maxflowDAG(G, inter, numinter);
+}
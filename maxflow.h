@@ -0,0 +1,39 @@
+#ifndef __MAXFLOW
+#define __MAXFLOW
+
+#include "computeflow.h"
+
+/* exact flow computation without lp_solve: max-flow on the time-expanded network of a DAG */
+/* every DAG node u (except source and sink) gets one vertex per distinct timestamp of its outgoing */
+/* interactions; holdover arcs between consecutive vertices of u model buffering; an interaction */
+/* u->v at time t is an arc from u's vertex of time t to v's first vertex with time later than t */
+/* (flow that arrives at t can only leave at a later time), with the quantity as capacity */
+/* interactions of the source leave a super-source, interactions into the sink enter a super-sink */
+/* the result equals computeFlowLPShared; outgoing interactions of a node at the same time share its buffer */
+/* (computeFlowLP bounds each of them separately by the buffer, so its flow can be larger) */
+
+// network arc; arc[a^1] is the reverse (residual) arc of arc[a]
+struct MFArc {
+	int to;
+	double cap; // residual capacity
+};
+
+// time-expanded network in compressed-sparse-row layout
+struct MFNetwork {
+	int numvert;
+	int numarcs;
+	int source; // super-source
+	int sink; // super-sink
+	int *start; // arcs leaving vertex v are adj[start[v]..start[v+1]-1]
+	int *adj; // arc indices, grouped by tail vertex
+	struct MFArc *arc;
+};
+
+// computes the flow throughout a DAG from its source (node at position 0)
+// to its sink (node at position G.numnodes-1) as a max-flow on the time-expanded network
+double computeFlowMaxflow(struct DAG G);
+
+// same as computeFlowMaxflow; returns incoming interactions to sink, which accumulate to total flow
+double computeFlowMaxflowWithInter(struct DAG G, struct Interaction **inter, int *numinter);
+
+#endif // __MAXFLOW
@@ -98,6 +98,88 @@ int dequeue(elem *el, elem *heap, int *num_elems)
     return 1;
 }
 
+/* moves element x down from position posel (a hole) until no child is smaller */
+/* children are compared first and moved up; x is written once, at its final position */
+static void siftdown4(elem *heap, int num_elems, int posel, elem x)
+{
+    int child;
+    int k, last, swap;
+
+    while ((child = 4*posel+1) < num_elems)
+    {
+        last = (child+4 < num_elems) ? child+4 : num_elems;
+        swap = child;
+        for (k=child+1; k<last; k++) /* smallest of up to 4 children, all in one cache line */
+            if (heap[k].value < heap[swap].value)
+                swap = k;
+        if (heap[swap].value >= x.value) /* stops at equal values, as movedown does */
+            break;
+        heap[posel] = heap[swap];
+        posel = swap;
+    }
+    heap[posel] = x;
+}
+
+/* position 1 (first child of the root) is put at the start of a cache line; */
+/* then every group of siblings 4i+1..4i+4 starts a cache line too */
+elem *alignheap4(elem *block)
+{
+    uintptr_t first = (uintptr_t)(block+1);
+    return block + ((HEAP4LINE - first%HEAP4LINE) % HEAP4LINE) / sizeof(elem);
+}
+
+/*enqueues element in 4-ary heap; parents are moved down into the hole*/
+void enqueue4(e_type el, int idx, elem *heap, int *num_elems)
+{
+    elem x;
+    int p;
+    int posel = (*num_elems)++;
+
+    x.value = el;
+    x.idx = idx;
+    while (posel > 0)
+    {
+        p = (posel-1)/4;
+        if (x.value >= heap[p].value)
+            break;
+        heap[posel] = heap[p];
+        posel = p;
+    }
+    heap[posel] = x;
+}
+
+void heapify4(elem *heap, int num_elems)
+{
+    int i;
+
+    if (num_elems < 2)
+        return;
+    for (i=(num_elems-2)/4; i>=0; i--)
+        siftdown4(heap, num_elems, i, heap[i]);
+}
+
+void replacetop4(e_type el, int idx, elem *heap, int *num_elems)
+{
+    elem x;
+
+    x.value = el;
+    x.idx = idx;
+    siftdown4(heap, *num_elems, 0, x);
+}
+
+/* returns the root element, moves the last element down from the root */
+int dequeue4(elem *el, elem *heap, int *num_elems)
+{
+    if ((*num_elems)==0) /* empty queue */
+        return 0;
+
+    *el = heap[0];
+    (*num_elems)--;
+    if (*num_elems > 0)
+        siftdown4(heap, *num_elems, 0, heap[*num_elems]);
+    return 1;
+}
+
 void print_heap(elem *heap, int num_elems) {
   int i;
 
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 /* used by minheap implementation - see minheap.c */
 typedef double e_type; /* replace this with your preferred type for the heap key */ 
@@ -17,4 +18,19 @@ void movedown(elem *heap, int *num_elems);
 int dequeue(elem *el, elem *heap, int *num_elems);
 void print_heap(elem *heap, int num_elems);
 
+/* 4-ary heap: the children of position i are 4i+1..4i+4 */
+/* the 4 children of a position fill one cache line if the heap is aligned with alignheap4 */
+#define HEAP4LINE 64 /* cache line size in bytes */
+#define HEAP4SLACK (HEAP4LINE/sizeof(elem)-1) /* extra elements to allocate for alignheap4 */
+
+/* returns the position in block (of at least num_elems+HEAP4SLACK elements, allocated with */
+/* malloc or dagalloc) where a 4-ary heap should start so that sibling groups share a cache line */
+elem *alignheap4(elem *block);
+void enqueue4(e_type el, int idx, elem *heap, int *num_elems);
+/* arranges heap[0..num_elems-1] as a 4-ary heap in linear time */
+void heapify4(elem *heap, int num_elems);
+/* replaces the root element with (el,idx) and moves it down; cheaper than dequeue4+enqueue4 */
+void replacetop4(e_type el, int idx, elem *heap, int *num_elems);
+int dequeue4(elem *el, elem *heap, int *num_elems);
+
 #endif // __MINHEAP
\ No newline at end of file
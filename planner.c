@@ -0,0 +1,124 @@
+/*per-DAG choice of the cheapest exact flow algorithm (see planner.h)*/
+#include <math.h>
+#include "planner.h"
+#include "query.h"
+#include "maxflow.h"
+
+static const char *plannames[NUMPLANS] = {"bounds","chain","decomp","lp","maxflow"};
+
+// default model: fitted on computeflowbatch runs of DAGs with 100 to 300000 interactions
+// (PrepTime+BoundTime for linear, LPTime for lp, MaxflowTime for maxflow)
+void initCostModel(struct CostModel *cm)
+{
+	cm->linear.coef = 3.2e-7;
+	cm->linear.exponent = 1.0;
+	cm->lp.coef = 4.6e-8;
+	cm->lp.exponent = 2.0;
+	cm->maxflow.coef = 1.7e-8;
+	cm->maxflow.exponent = 1.6;
+}
+
+int readCostModel(struct CostModel *cm, char *filename)
+{
+	char name[32];
+	double coef, exponent;
+
+	FILE *f = fopen(filename,"r");
+	if (f==NULL)
+	{
+		printf("ERROR: file %s does not exist.\n",filename);
+		return -1;
+	}
+	while (fscanf(f,"%31s %lf %lf",name,&coef,&exponent)==3) {
+		struct CostTerm *t = NULL;
+		if (!strcmp(name,"linear"))
+			t = &cm->linear;
+		else if (!strcmp(name,"lp"))
+			t = &cm->lp;
+		else if (!strcmp(name,"maxflow"))
+			t = &cm->maxflow;
+		else {
+			printf("ERROR: unknown cost term %s in %s\n",name,filename);
+			fclose(f);
+			return -1;
+		}
+		t->coef = coef;
+		t->exponent = exponent;
+	}
+	fclose(f);
+	return 0;
+}
+
+static double cost(const struct CostTerm *t, double numinter)
+{
+	return t->coef*pow(numinter, t->exponent);
+}
+
+int dagStats(struct DAG *G, struct DAGStats *s)
+{
+	s->numnodes = G->numnodes;
+	s->numedges = G->numedges;
+	s->totinter = 0;
+	for (int i=0; i<G->numedges; i++)
+		s->totinter += G->edgearray[i]->numinter;
+	s->numchain = 0;
+	for (int i=1; i<G->numnodes-1; i++)
+		if (G->node[i].numinc==1 && G->node[i].numout==1)
+			s->numchain++;
+	return computeFlowBounds(G, &s->bounds);
+}
+
+int choosePlan(const struct DAGStats *s, const struct CostModel *cm, double *predicted)
+{
+	double numinter = s->totinter;
+	// interactions left for the LP after the chains are reduced (assuming they are spread evenly)
+	double rest = (s->numnodes > 2) ? numinter*(s->numnodes-2-s->numchain)/(s->numnodes-2) : numinter;
+	int best = -1;
+
+	predicted[PLAN_BOUNDS] = boundsDecided(&s->bounds) ? 0 : -1;
+	predicted[PLAN_CHAIN] = (s->numchain == s->numnodes-2) ? 0 : -1;
+	predicted[PLAN_DECOMP] = (s->totinter<MAXLPINTER) ? 2*cost(&cm->linear,numinter)+cost(&cm->lp,rest) : -1;
+	predicted[PLAN_LP] = (s->totinter<MAXLPINTER) ? cost(&cm->linear,numinter)+cost(&cm->lp,numinter) : -1;
+	predicted[PLAN_MAXFLOW] = cost(&cm->maxflow,numinter);
+	for (int i=0; i<NUMPLANS; i++)
+		if (predicted[i] >= 0 && (best == -1 || predicted[i] < predicted[best]))
+			best = i;
+	return best;
+}
+
+int planFlow(struct DAG *G, const struct CostModel *cm, struct FlowPlan *p)
+{
+	double t = walltime();
+
+	if (dagStats(G, &p->stats)==-1)
+		return -1;
+	p->plan = choosePlan(&p->stats, cm, p->predicted);
+	p->statstime = walltime()-t;
+
+	t = walltime();
+	if (p->plan==PLAN_BOUNDS || p->plan==PLAN_CHAIN) // the greedy lower bound is the flow
+		p->flow = p->stats.bounds.lower;
+	else if (p->plan==PLAN_MAXFLOW)
+		p->flow = computeFlowMaxflow(*G);
+	else {
+		int numdeletedinter = 0;
+		int numdeletededges = 0;
+		int numdeletednodes = 0;
+		int *order = topoorder(G);
+		struct DAG *retDAG = preprocessDAG(G, order, &numdeletedinter, &numdeletededges, &numdeletednodes);
+		if (retDAG==NULL) // sink disconnected
+			p->flow = 0;
+		else if (p->plan==PLAN_DECOMP)
+			p->flow = compFlow(*retDAG, 0);
+		else
+			p->flow = computeFlowLPShared(*retDAG);
+		free(order);
+	}
+	p->actual = walltime()-t;
+	return 0;
+}
+
+const char *plan_name(int plan)
+{
+	return (plan>=0 && plan<NUMPLANS) ? plannames[plan] : "unknown";
+}
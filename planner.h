@@ -0,0 +1,69 @@
+#ifndef __PLANNER
+#define __PLANNER
+
+#include "computeflow.h"
+#include "bounds.h"
+
+/* per-DAG choice of the cheapest exact flow algorithm */
+/* the planner collects statistics of the DAG (size, nodes with one incoming and one outgoing edge, */
+/* flow bounds), predicts the time of every applicable strategy with a cost model and runs the cheapest */
+/* the time of a strategy on I interactions is modelled as coef*I^exponent (a line in log-log scale), */
+/* so the model is recalibrated by fitting the predicted and actual times logged by computeflowbatch */
+
+#define PLAN_BOUNDS 0 // the flow bounds meet: the flow is the lower bound
+#define PLAN_CHAIN 1 // all nodes but source and sink have one incoming and one outgoing edge: greedy is exact
+#define PLAN_DECOMP 2 // preprocessing, DAG reduction, LP on the rest (compFlow)
+#define PLAN_LP 3 // preprocessing, then LP (LPMODEL_SHARED, so that the flow is exact)
+#define PLAN_MAXFLOW 4 // max-flow on the time-expanded network
+#define NUMPLANS 5
+
+// time of a strategy on I interactions: coef*I^exponent seconds
+struct CostTerm {
+	double coef;
+	double exponent;
+};
+
+struct CostModel {
+	struct CostTerm linear; // one pass over the interactions (preprocessing, reduction)
+	struct CostTerm lp; // LP solve
+	struct CostTerm maxflow; // max-flow
+};
+
+struct DAGStats {
+	int numnodes;
+	int numedges;
+	int totinter;
+	int numchain; // nodes (except source and sink) with one incoming and one outgoing edge
+	struct FlowBounds bounds;
+};
+
+struct FlowPlan {
+	struct DAGStats stats;
+	int plan; // chosen strategy
+	double predicted[NUMPLANS]; // predicted seconds of every strategy, -1 if not applicable
+	double statstime; // seconds spent on statistics and bounds
+	double actual; // seconds spent on the chosen strategy
+	double flow;
+};
+
+// sets the default model, fitted on batch runs of small and large DAGs (see planner.c)
+void initCostModel(struct CostModel *cm);
+
+// reads a model from a file with lines "<term> <coef> <exponent>" (term is linear, lp or maxflow);
+// terms not in the file keep their value; returns 0 on success, -1 on error
+int readCostModel(struct CostModel *cm, char *filename);
+
+// collects the statistics of DAG G; returns 0 on success, -1 if G is not a DAG
+int dagStats(struct DAG *G, struct DAGStats *s);
+
+// returns the cheapest strategy for a DAG with statistics s and stores all predictions in predicted
+int choosePlan(const struct DAGStats *s, const struct CostModel *cm, double *predicted);
+
+// computes the flow of DAG G with the strategy chosen by choosePlan (G may be preprocessed in place)
+// returns 0 on success, -1 if G is not a DAG
+int planFlow(struct DAG *G, const struct CostModel *cm, struct FlowPlan *p);
+
+// returns name of strategy plan
+const char *plan_name(int plan);
+
+#endif // __PLANNER
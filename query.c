@@ -0,0 +1,173 @@
+/*single-vertex flow queries against a graph kept in memory*/
+#include "query.h"
+#include "graphbin.h"
+#include "graphpar.h"
+#include "maxflow.h"
+#include "bounds.h"
+#include "planner.h"
+
+static const char *algonames[NUMALGOS] = {"greedy","lp","prelp","decomp","maxflow","timeline","auto","greedy4"};
+
+// wall-clock time in seconds
+double walltime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// loads a graph file of any supported format (binary, or text parsed with numthreads threads)
+// returns 0 on success, -1 on error
+int load_graph(struct Graph *G, char *filename, int numthreads)
+{
+	FILE *f;
+
+	if (is_graph_bin(filename)) // binary graph produced by convertgraph
+		return read_graph_bin(G, filename);
+	if (numthreads > 1)
+		return read_graph_parallel(G, filename, numthreads);
+
+	f = fopen(filename,"r");
+	if (f==NULL)
+	{
+		printf("ERROR: file %s does not exist. Exiting...\n",filename);
+		return -1;
+	}
+	return read_graph(G, f);
+}
+
+// returns algorithm id for a name (greedy, lp, prelp, decomp, maxflow, timeline, auto, greedy4), -1 if unknown
+int algo_from_name(char *name)
+{
+	for (int i=0; i<NUMALGOS; i++)
+		if (!strcmp(name,algonames[i]))
+			return i;
+	return -1;
+}
+
+// returns name of algorithm id
+const char *algo_name(int algo)
+{
+	return (algo>=0 && algo<NUMALGOS) ? algonames[algo] : "unknown";
+}
+
+// solves the LP of DAG G with model model in at most lptimeout seconds (0: no limit); if it runs out of time, the flow
+// is only known to lie in [res->lower,res->upper], found from the solution so far and the bounds b
+static void solveLP(struct DAG *G, int model, long lptimeout, const struct FlowBounds *b, struct QueryResult *res)
+{
+	int optimal;
+	double flow = computeFlowLPTimed(*G, model, lptimeout, &optimal);
+
+	if (optimal) {
+		res->flow = flow;
+		return;
+	}
+	res->exact = 0;
+	res->lower = (flow > b->lower) ? flow : b->lower;
+	res->upper = b->upper;
+	res->flow = res->lower;
+}
+
+// computes the flow of source=sink vertex source over paths of at most maxlen nodes
+// follows the same steps as computeflowsingle, but runs only the requested algorithm
+// and writes no files; the LP algorithms are skipped if the bounds of the DAG decide the flow (see bounds.h)
+int runQuery(struct Graph *G, int source, int maxlen, int algo, long lptimeout, struct EdgeSet *es, struct PathScratch *ps, struct Arena *arena, struct QueryResult *res, const char **errmsg)
+{
+	struct DAG *G2;
+	struct DAG *retDAG = NULL;
+	struct FlowBounds b;
+	int numedges;
+	int ret = 0;
+	double t;
+
+	memset(res,0,sizeof(struct QueryResult));
+	if (source<0 || source>=G->numnodes) {
+		*errmsg = "vertex-id out of range";
+		return -1;
+	}
+	if (maxlen<2) {
+		*errmsg = "path length must be at least 2";
+		return -1;
+	}
+	if (algo<0 || algo>=NUMALGOS) {
+		*errmsg = "unknown algorithm";
+		return -1;
+	}
+
+	t = walltime();
+	res->totinter = findPaths2(*G,source,source,maxlen,es,ps);
+	numedges = es->numedges;
+	res->numedges = numedges;
+	if (numedges==0) {
+		res->pathtime = walltime()-t;
+		*errmsg = "no paths found";
+		return -1;
+	}
+	G2 = edgearray2DAG(es->edge, numedges, source, 0, arena);
+	res->numnodes = G2->numnodes;
+	res->pathtime = walltime()-t;
+
+	t = walltime();
+	res->exact = 1;
+	if (algo==ALGO_GREEDY)
+		res->flow = computeFlowGreedy(*G2);
+	else if (algo==ALGO_GREEDY4)
+		res->flow = computeFlowGreedyHeap4(*G2);
+	else if (algo==ALGO_TIMELINE)
+		res->flow = computeFlowGreedyTimeline(*G2);
+	else if (algo==ALGO_MAXFLOW)
+		res->flow = computeFlowMaxflow(*G2);
+	else if (algo==ALGO_AUTO) {
+		struct CostModel cm;
+		struct FlowPlan p;
+		initCostModel(&cm);
+		if (planFlow(G2, &cm, &p)==-1) {
+			*errmsg = "extracted graph is not a DAG";
+			ret = -1;
+		}
+		else
+			res->flow = p.flow;
+	}
+	else if (computeFlowBounds(G2, &b)==-1) {
+		*errmsg = "extracted graph is not a DAG";
+		ret = -1;
+	}
+	else if (boundsDecided(&b)) // no need for the LP
+		res->flow = b.lower;
+	else if (algo==ALGO_LP) {
+		if (res->totinter>=MAXLPINTER) {
+			*errmsg = "too many interactions for LP";
+			ret = -1;
+		}
+		else
+			solveLP(G2, LPMODEL_INTER, lptimeout, &b, res);
+	}
+	else { // the LP of prelp and decomp is limited by the interactions left after preprocessing
+		int *order = topoorder(G2);
+		int numdeletedinter=0;
+		int numdeletededges=0;
+		int numdeletednodes=0;
+		retDAG = preprocessDAG(G2, order, &numdeletedinter, &numdeletededges, &numdeletednodes);
+		if (retDAG==NULL)
+			res->flow = 0; // sink disconnected
+		else if (res->totinter-numdeletedinter>=MAXLPINTER) {
+			*errmsg = "too many interactions for LP after preprocessing";
+			ret = -1;
+		}
+		else if (algo==ALGO_PRELP)
+			solveLP(retDAG, LPMODEL_SHARED, lptimeout, &b, res); // preprocessing keeps the max flow only
+		else
+			res->flow = compFlow(*retDAG, 0);
+		free(order);
+	}
+	if (res->exact)
+		res->lower = res->upper = res->flow;
+	res->flowtime = walltime()-t;
+
+	if (retDAG != NULL && retDAG != G2)
+		freeDAG(retDAG);
+	freeDAG(G2);
+	if (arena != NULL)
+		resetArena(arena);
+	return ret;
+}
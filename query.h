@@ -0,0 +1,53 @@
+#ifndef __QUERY
+#define __QUERY
+
+#include "computeflow.h"
+
+/* single-vertex flow queries against a graph kept in memory */
+/* used by the query server (computeflowserver) and the batch driver (computeflowbatch) */
+
+#define ALGO_GREEDY 0 // greedy algorithm on the extracted DAG
+#define ALGO_LP 1 // LP on the extracted DAG
+#define ALGO_PRELP 2 // preprocessing, then LP
+#define ALGO_DECOMP 3 // preprocessing, chain simplification, then LP
+#define ALGO_MAXFLOW 4 // max-flow on the time-expanded network (no size limit)
+#define ALGO_TIMELINE 5 // greedy algorithm as one pass over the DAG's sorted interactions
+#define ALGO_AUTO 6 // exact algorithm chosen per DAG by the cost model of planner.h
+#define ALGO_GREEDY4 7 // greedy algorithm with a 4-ary heap (ties may be taken in another order)
+#define NUMALGOS 8
+
+struct QueryResult {
+	int numnodes; // size of extracted DAG
+	int numedges;
+	int totinter;
+	double flow; // flow from source to sink (same vertex)
+	int exact; // 0 if the LP ran out of time: the flow is then only known to lie in [lower,upper]
+	double lower; // equal to flow if exact
+	double upper;
+	double pathtime; // seconds spent extracting the DAG
+	double flowtime; // seconds spent computing the flow
+};
+
+// loads a graph file of any supported format (binary, or text parsed with numthreads threads)
+// returns 0 on success, -1 on error
+int load_graph(struct Graph *G, char *filename, int numthreads);
+
+// wall-clock time in seconds (unlike clock(), not summed over threads)
+double walltime();
+
+// returns algorithm id for a name (greedy, lp, prelp, decomp, maxflow, timeline, auto, greedy4), -1 if unknown
+int algo_from_name(char *name);
+
+// returns name of algorithm id
+const char *algo_name(int algo);
+
+// computes the flow of source=sink vertex source over paths of at most maxlen nodes
+// es and ps are scratch space for the path search, owned by the caller (see initEdgeSet, initPathScratch)
+// the DAGs of the query are allocated from arena, which is reset before returning (NULL: malloc)
+// the LP of algorithms lp and prelp is given lptimeout seconds (0: no limit); LP algorithms are skipped
+// if cheap bounds decide the flow (see bounds.h)
+// returns 0 on success, -1 if no DAG could be extracted or the algorithm could not run
+// (*errmsg then describes the reason)
+int runQuery(struct Graph *G, int source, int maxlen, int algo, long lptimeout, struct EdgeSet *es, struct PathScratch *ps, struct Arena *arena, struct QueryResult *res, const char **errmsg);
+
+#endif // __QUERY